@@ -0,0 +1,100 @@
+#include <iostream>
+#include <string>
+#include <new>
+#include <cstdlib>
+#include <json/json.h>
+
+// every allocation made while counting is true is counted
+static bool counting = false;
+static size_t allocations = 0;
+
+static void* allocate(size_t size, size_t alignment) {
+    if (counting) {
+        allocations++;
+    }
+    void* pointer = alignment > alignof(std::max_align_t) ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment) : std::malloc(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new(size_t size) { return allocate(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return allocate(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocate(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocate(size, (size_t)alignment); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+/**
+ * Returns the number of allocations a value needs : the block of each string, object and array, the characters
+ * of the strings that do not fit in a std::string, the long keys and the storage of the members and elements.
+ */
+static size_t countNeeded(const JSON::Value& value) {
+    size_t needed = 0;
+    switch (value.getType()) {
+        case JSON::Type::STRING:
+            needed = value.getStringValue().capacity() > std::string().capacity() ? 2 : 1;
+            break;
+        case JSON::Type::OBJECT:
+            needed = 1;
+            for (const auto& member : value.getObjectValue()) {
+                // a key of more than 15 bytes is an atom holding its name
+                needed += member.first.size() > 15 ? 2 : 0;
+                needed += countNeeded(member.second);
+            }
+#if defined(JSON_FLAT_OBJECT)
+            needed += value.getObjectValue().empty() ? 0 : 1;
+#elif defined(JSON_HASH_OBJECT)
+            // the entries, and the index of an object of more than 8 members
+            needed += value.getObjectValue().empty() ? 0 : value.getObjectValue().size() > 8 ? 2 : 1;
+#else
+            needed += value.getObjectValue().size();
+#endif
+            break;
+        case JSON::Type::ARRAY:
+            needed = value.getArrayValue().empty() ? 1 : 2;
+            for (const JSON::Value& element : value.getArrayValue()) {
+                needed += countNeeded(element);
+            }
+            break;
+        default:
+            break;
+    }
+    return needed;
+}
+
+int main() {
+
+    std::string json = "[";
+    for (int i = 0; i < 1000; i++) {
+        json += i > 0 ? "," : "";
+        json += "{\"id\":" + std::to_string(i) + ",\"identifier\":\"record number " + std::to_string(i) + " of the example\",";
+        json += "\"name\":\"short\",\"values\":[1,2.5,3,4,5,6,7,8],\"tags\":[\"a\",\"b\"],";
+        json += "\"details\":{\"a long key for the atom\":true,\"empty\":{},\"none\":[]}}";
+    }
+    json += "]";
+
+    // the parser allocates its own buffers and stack, which do not depend on the size of the document
+    const size_t parserAllocations = 64;
+
+    counting = true;
+    JSON::Value value = JSON::parse(json);
+    counting = false;
+
+    size_t needed = countNeeded(value);
+    std::cout << allocations << " allocations for " << needed << " needed" << std::endl;
+
+    if (allocations > needed + parserAllocations) {
+        std::cout << "Too many allocations" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
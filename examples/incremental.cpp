@@ -0,0 +1,29 @@
+#include <iostream>
+#include <json/incremental.h>
+
+int main() {
+
+    JSON::IncrementalParser parser;
+
+    try {
+
+        parser.parse(R"({ "name": "clodsire", "stats": { "hp": 130, "speed": 20 } })");
+
+        std::cout << parser.getValue() << std::endl;
+
+        // replace 130 by 131, only the number is parsed again
+        parser.edit(parser.getText().find("130"), 3, "131");
+
+        std::cout << parser.getValue() << std::endl;
+
+        // add a key, only the "stats" object is parsed again
+        parser.edit(parser.getText().find("}"), 0, ", \"attack\": 75 ");
+
+        std::cout << parser.getValue() << std::endl;
+
+    } catch (const JSON::Error& error) {
+        std::cout << std::endl << "Error: " << error << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
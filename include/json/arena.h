@@ -0,0 +1,167 @@
+#ifndef _JSON_ARENA_H_
+#define _JSON_ARENA_H_
+
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+namespace JSON {
+
+/**
+ * A monotonic memory resource for building large values.
+ * Memory is taken from the system in large chunks and handed out by bumping a pointer,
+ * deallocations are ignored and everything is released at once when the arena is destroyed.
+ * While an Arena::Scope is alive, the objects and arrays created in the current thread are allocated in the arena,
+ * for example to parse a document :
+ *
+ *     JSON::Arena arena;
+ *     JSON::Value value;
+ *     {
+ *         JSON::Arena::Scope scope(arena);
+ *         value.parse(input);
+ *     }
+ *
+ * The values allocated in an arena must be destroyed before the arena.
+ * Destroying them still runs the destructor of every node, so the teardown is O(nodes) : only the deallocations
+ * are free. The nodes cannot be dropped with the arena, since the characters of long strings come from the
+ * global heap, long keys are counted references to shared atoms, and blocks can be shared with values outside
+ * the arena. The teardown can be moved off a latency-sensitive thread by retiring the root value to a Reclaimer
+ * (see Reclaimer::retire), whose wait() must then return before the arena is destroyed.
+ * An arena is not thread-safe.
+ */
+class Arena : public std::pmr::memory_resource {
+
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    size_t chunkSize;
+    bool hugePages;
+    std::vector<Chunk> chunks;
+    char* current;
+    char* end;
+    size_t used;
+
+    Chunk allocateChunk(size_t size);
+    void deallocateChunk(const Chunk& chunk);
+
+protected:
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+
+    /**
+     * Makes the given arena the current memory resource of the thread until the scope is destroyed.
+     * Scopes can be nested.
+     */
+    class Scope {
+
+        std::pmr::memory_resource* previous;
+
+    public:
+
+        Scope(std::pmr::memory_resource& resource);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /**
+     * Creates an empty arena.
+     * The chunkSize parameter is the size of the blocks of memory taken from the system.
+     * If hugePages is true, the chunks are mapped with huge pages when the system supports it.
+     */
+    Arena(size_t chunkSize = 1 << 20, bool hugePages = false);
+
+    /**
+     * Releases all the memory of the arena.
+     */
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Releases all the memory of the arena.
+     * The values allocated in the arena must have been destroyed.
+     */
+    void release();
+
+    /**
+     * Returns the number of bytes allocated in the arena.
+     */
+    size_t getUsedSize() const;
+
+    /**
+     * Returns the number of bytes taken from the system.
+     */
+    size_t getReservedSize() const;
+
+    /**
+     * Returns the memory resource of the current scope in this thread,
+     * or the default new/delete resource if there is no scope.
+     */
+    static std::pmr::memory_resource* getCurrent();
+};
+
+/**
+ * The allocator of objects and arrays.
+ * A default constructed allocator uses the current memory resource of the thread (see Arena::Scope).
+ * The allocator moves along with the content of a container, so moving a value never copies its children.
+ */
+template <class T>
+class Allocator {
+
+    std::pmr::memory_resource* resource;
+
+public:
+
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    Allocator() noexcept : resource(Arena::getCurrent()) {}
+    Allocator(std::pmr::memory_resource* resource) noexcept : resource(resource) {}
+
+    template <class U>
+    Allocator(const Allocator<U>& allocator) noexcept : resource(allocator.getResource()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t n) {
+        resource->deallocate(pointer, n * sizeof(T), alignof(T));
+    }
+
+    /**
+     * Copies are allocated with the current memory resource, not with the one of the original.
+     */
+    Allocator select_on_container_copy_construction() const {
+        return Allocator();
+    }
+
+    std::pmr::memory_resource* getResource() const {
+        return resource;
+    }
+
+    template <class U>
+    bool operator==(const Allocator<U>& allocator) const {
+        return resource == allocator.getResource() || resource->is_equal(*allocator.getResource());
+    }
+
+    template <class U>
+    bool operator!=(const Allocator<U>& allocator) const {
+        return !(*this == allocator);
+    }
+};
+
+}
+
+#endif
\ No newline at end of file
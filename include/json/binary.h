@@ -0,0 +1,120 @@
+#ifndef _JSON_BINARY_H_
+#define _JSON_BINARY_H_
+
+#include <json/type.h>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+namespace JSON {
+
+/**
+ * A class to print JSON data in a stream in a binary format, CBOR (RFC 8949) or MessagePack.
+ * It has the same interface as Printer, and the data can be read back with Parser::parse or Value::parse.
+ * The sizes of the objects and arrays can be given when they are started, so that they are written in their
+ * header. If a size is not known, a CBOR container is written with an indefinite length and a MessagePack
+ * container, which must have a size, is kept in memory until the outermost container of unknown size ends.
+ * Integers are written with the smallest encoding and doubles as 32-bit floats when no precision is lost.
+ * No syntax check is done, and the given sizes must be the number of members or elements printed.
+ */
+class BinaryPrinter {
+
+    /**
+     * An object or array being printed, with the number of members or elements printed so far.
+     */
+    struct Container {
+        bool object;
+        size_t size;
+        size_t count;
+        size_t header;
+    };
+
+    /**
+     * The position of the header of a buffered MessagePack container, which is written when it is flushed.
+     */
+    struct Header {
+        size_t position;
+        bool object;
+        size_t size;
+    };
+
+    std::ostream& output;
+    Format format;
+    std::vector<Container> containers;
+    std::vector<Header> headers;
+    std::string buffer, chunks;
+    size_t buffered = 0;
+
+    void write(const char* data, size_t size);
+    void writeByte(unsigned char byte);
+    void writeBigEndian(unsigned char type, uint64_t value, size_t size);
+    void writeHead(int major, uint64_t argument);
+    void writeString(const char* str, size_t size);
+    void writeUnsigned(uint64_t value);
+    void writeContainerHead(bool object, size_t size);
+    void startContainer(bool object, size_t size);
+    void endContainer();
+    void countItem(bool key);
+    void flush();
+
+public:
+
+    /**
+     * The size of a container whose size is not known when it starts.
+     */
+    static constexpr size_t unknownSize = (size_t)-1;
+
+    /**
+     * Creates a printer for a given stream and binary format.
+     * Throws an std::invalid_argument exception if the format is Format::TEXT, which is printed by Printer.
+     */
+    BinaryPrinter(std::ostream& output, Format format);
+
+    /**
+     * Prints object delimiters.
+     * The size is the number of members of the object, if it is known.
+     */
+    void startObject(size_t size = unknownSize);
+    void endObject();
+
+    /**
+     * Prints array delimiters.
+     * The size is the number of elements of the array, if it is known.
+     */
+    void startArray(size_t size = unknownSize);
+    void endArray();
+
+    /**
+     * Prints an object key.
+     * Do not use this to print a string value or vice-versa.
+     */
+    void key(const char* key);
+    void key(const std::string& key);
+
+    /**
+     * Prints a value.
+     */
+    void value(const char* value);
+    void value(const std::string& value);
+    void value(double value);
+    void value(int64_t value);
+    void value(uint64_t value);
+    void value(bool value);
+    void value();
+
+    /**
+     * Prints a string value in several parts.
+     * In CBOR, each chunk is written as a part of a string of indefinite length.
+     * In MessagePack, the chunks are kept in memory until the end of the string.
+     */
+    void startString();
+    void stringChunk(const char* chunk);
+    void stringChunk(const std::string& chunk);
+    void endString();
+};
+
+}
+
+#endif
\ No newline at end of file
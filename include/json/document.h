@@ -0,0 +1,325 @@
+#ifndef _JSON_DOCUMENT_H_
+#define _JSON_DOCUMENT_H_
+
+#include <json/value.h>
+#include <json/type.h>
+#include <json/error.h>
+#include <json/printer.h>
+#include <json/path.h>
+#include <json/path/cursor.h>
+#include <json/tape.h>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <istream>
+#include <ostream>
+#include <memory>
+#include <cstdint>
+
+namespace JSON {
+
+class Document;
+
+/**
+ * A read-only view of a value in a Document.
+ * An element is only a position in the document, it is cheap to copy and must not be used after the document
+ * is modified or destroyed. A default constructed element is undefined.
+ * The accessors follow the ones of Value and throw the same exceptions.
+ */
+class Element {
+
+    friend class Document;
+
+    const Document* document = nullptr;
+    size_t index = 0;
+
+    Element(const Document* document, size_t index);
+
+    Value getNumber() const;
+    Element findMember(std::string_view key) const;
+
+    bool findFirst(Path::Cursor& cursor, Element& result) const;
+    void findAll(std::vector<Element>& all, Path::Cursor& cursor) const;
+
+public:
+
+    /**
+     * An iterator over the values of an object or an array, in the order of the document.
+     * The key of an object member is given by getKey().
+     */
+    class Iterator {
+
+        friend class Element;
+
+        const Document* document;
+        size_t index;
+        bool object;
+
+        Iterator(const Document* document, size_t index, bool object);
+
+    public:
+
+        Element operator*() const;
+        Iterator& operator++();
+        bool operator==(const Iterator& iterator) const;
+        bool operator!=(const Iterator& iterator) const;
+
+        /**
+         * Returns the key of the current member of an object.
+         */
+        std::string_view getKey() const;
+    };
+
+    /**
+     * Creates an undefined element.
+     */
+    Element() = default;
+
+    /**
+     * Returns the type of the value.
+     */
+    Type getType() const;
+
+    /**
+     * Returns true if the value is of the given type.
+     */
+    bool hasType(Type type) const;
+
+    /**
+     * Returns true if the element is undefined.
+     */
+    bool isUndefined() const;
+
+    /**
+     * Throws a Value::TypeAssertionError exception if the value is not of the given type.
+     */
+    void assertType(Type type) const;
+
+    /**
+     * Returns the representation of a number value.
+     */
+    NumberType getNumberType() const;
+
+    /**
+     * Returns the value as the given type, with the same conversions as Value.
+     * The string is stored in the document.
+     */
+    Number getNumberValue() const;
+    Integer getIntegerValue() const;
+    Unsigned getUnsignedValue() const;
+    Boolean getBooleanValue() const;
+    Null getNullValue() const;
+    std::string_view getStringValue() const;
+
+    /**
+     * Returns the number of values in an object or an array.
+     * Throws a Value::TypeAssertionError exception if the value is neither an object nor an array.
+     */
+    size_t getSize() const;
+
+    /**
+     * Returns the value at the given key for an object.
+     * The key is found by a binary search in large objects, which are indexed, and by a scan in the others.
+     * If the object contains multiple values with the same key, the last one is returned, as in Value.
+     * Throws a Value::TypeAssertionError exception if the value is not an object.
+     * Throws a Value::KeyError exception if the key is not found.
+     */
+    Element operator[](std::string_view key) const;
+
+    /**
+     * Returns the value at the given index for an array.
+     * The values before it are skipped without being read.
+     * Throws a Value::TypeAssertionError exception if the value is not an array.
+     * Throws a Value::KeyError exception if the index is out of bounds.
+     */
+    Element operator[](size_t index) const;
+
+    /**
+     * Returns iterators over the values of an object or an array.
+     * Throws a Value::TypeAssertionError exception if the value is neither an object nor an array.
+     */
+    Iterator begin() const;
+    Iterator end() const;
+
+    /**
+     * Finds the first sub-value matching the given path.
+     * Returns an undefined element if no value is found.
+     */
+    Element findFirst(const Path& path) const;
+
+    /**
+     * Finds all sub-values matching the given path.
+     */
+    std::vector<Element> findAll(const Path& path) const;
+
+    /**
+     * Prints the value using the given printer.
+     */
+    void print(Printer& printer) const;
+
+    /**
+     * Creates a printer with the given parameters and prints the value.
+     */
+    void print(std::ostream& output, int indent = 0, bool escapeUnicode = true, bool color = false) const;
+
+    /**
+     * Returns a copy of the value that can be modified.
+     */
+    Value toValue() const;
+};
+
+/**
+ * A read-only JSON document stored in one contiguous tape.
+ * Each value is a 64-bit word holding its type and a payload, followed by a second word for numbers and strings.
+ * An object or an array is enclosed by a start word that holds the position after its end, so that it can be
+ * skipped in one step, and an end word that holds its size. An object of at least 16 members is also indexed :
+ * the positions of its keys, sorted by key, are stored just before its end word. The strings and keys are
+ * stored in a single buffer, and the tape only holds positions, so it can be saved as it is and mapped back
+ * in memory (see save() and map()).
+ * The values are in the order of the document, so traversing it reads the memory sequentially.
+ * Unlike Value, the members of an object keep the order of the input, including duplicate keys.
+ * The values are read through Element views, see getRoot().
+ * Parsing a new document in the same Document reuses its memory.
+ */
+class Document {
+
+    friend class Element;
+    friend class DocumentParser;
+
+public:
+
+    /**
+     * Exception thrown when a file is not a snapshot that can be mapped by this build.
+     */
+    struct SnapshotError : JSON::Error {
+        SnapshotError(const std::string& reason);
+    };
+
+private:
+
+    enum class Tag : unsigned char {
+        OBJECT,
+        OBJECT_END,
+        ARRAY,
+        ARRAY_END,
+        STRING,
+        DOUBLE,
+        INT64,
+        UINT64,
+        TRUE_,
+        FALSE_,
+        NULL_
+    };
+
+    static constexpr size_t indexedSize = 16;
+
+    std::vector<uint64_t> words;
+    std::string strings;
+
+    // the tape that is read, which is either in the vectors above or in a mapped snapshot
+    const uint64_t* wordData = nullptr;
+    size_t wordCount = 0;
+    const char* stringData = nullptr;
+    size_t stringSize = 0;
+    std::shared_ptr<const void> mapping;
+
+    void attach();
+    void attach(const Document& document);
+    void append(Tag tag, uint64_t payload = 0);
+    void appendString(std::string_view value);
+    void appendIndex(std::vector<uint64_t>& keys, size_t first);
+
+    Tag getTag(size_t index) const;
+    uint64_t getPayload(size_t index) const;
+    std::string_view getString(size_t index) const;
+    const char* getCString(size_t index) const;
+    size_t next(size_t index) const;
+
+public:
+
+    /**
+     * Creates an empty document.
+     */
+    Document() = default;
+
+    /**
+     * Creates a document parsed from the given input stream.
+     */
+    Document(std::istream& input);
+
+    /**
+     * Creates a document holding a copy of the given value.
+     */
+    Document(const Value& value);
+
+    /**
+     * A copy of a mapped document shares the mapping.
+     */
+    Document(const Document& document);
+    Document(Document&& document) noexcept;
+    Document& operator=(const Document& document);
+    Document& operator=(Document&& document) noexcept;
+
+    /**
+     * Parses a document from the given input stream, replacing the current one.
+     * Throws a Lexer::Error or a Parser::Error exception if the syntax is invalid.
+     */
+    void parse(std::istream& input);
+
+    /**
+     * Same as parse() but syntax errors are not thrown, they are described by the returned status.
+     * The document is empty if an error occurs.
+     */
+    Status tryParse(std::istream& input);
+
+    /**
+     * Same as parse() but the tokens are replayed from a tape.
+     */
+    void parse(const Tape& tape);
+
+    /**
+     * Replaces the document with a copy of the given value.
+     * Throws a Value::UndefinedValueError exception if the value contains undefined values.
+     */
+    void assign(const Value& value);
+
+    /**
+     * Writes the document to the given stream as a snapshot, which is its tape and its strings after a header.
+     * The snapshot can only be read by a build with the same byte order.
+     */
+    void save(std::ostream& output) const;
+
+    /**
+     * Replaces the document with the snapshot in the given file, which is mapped in memory and read in place :
+     * nothing is parsed or copied, and the pages are only loaded when they are accessed.
+     * The mapping is released when the document and its copies are cleared or destroyed.
+     * The header is checked, but not the content, so the file must have been written by save().
+     * Throws a std::system_error exception if the file cannot be mapped,
+     * and a SnapshotError exception if it is not a snapshot.
+     */
+    void map(const std::string& path);
+
+    /**
+     * Removes the content of the document, its memory is kept for the next parse.
+     */
+    void clear();
+
+    /**
+     * Returns the root value, or an undefined element if the document is empty.
+     */
+    Element getRoot() const;
+
+    /**
+     * Returns the number of bytes used by the tape, the indexes and the strings.
+     */
+    size_t getUsedSize() const;
+};
+
+}
+
+/**
+ * Prints the element using Element::print()
+ */
+std::ostream& operator<<(std::ostream& output, const JSON::Element& element);
+
+#endif
\ No newline at end of file
@@ -4,21 +4,90 @@
 #include <string>
 #include <exception>
 #include <ostream>
+#include <cstddef>
 
 namespace JSON {
 
+enum class Token;
+
 /**
  * Base class for all JSON errors
  */
 class Error : public std::exception {
 protected:
-    std::string message; 
+    std::string message;
 public:
     const char* what() const noexcept override;
 };
 
+/**
+ * The result of a lexing or parsing operation that does not throw.
+ * It only holds a compact error code and the position of the error,
+ * the message is formatted on demand by message().
+ */
+struct Status {
+
+    /**
+     * The different types of errors.
+     */
+    enum Code : unsigned char {
+        OK,                              // No error.
+        INVALID_CHARACTER,               // An invalid character was encountered.
+        INVALID_NUMBER,                  // A number was not correctly formatted.
+        UNTERMINATED_STRING,             // A string was not terminated before the end of the stream.
+        INVALID_ESCAPE_SEQUENCE,         // An invalid escape sequence was encountered.
+        INVALID_UNICODE_ESCAPE_SEQUENCE, // An invalid unicode escape sequence was encountered.
+        UNEXPECTED_TOKEN                 // A valid token was read where it is not allowed.
+    };
+
+    /**
+     * The type of error.
+     */
+    Code code = OK;
+
+    /**
+     * The character that caused a lexing error.
+     */
+    char c = '\0';
+
+    /**
+     * The token that caused a parsing error.
+     */
+    Token token = Token();
+
+    /**
+     * The byte offset of the error in the input.
+     */
+    size_t offset = 0;
+
+    /**
+     * The line and character position of the error in the input.
+     */
+    int lineNumber = 0, charPos = 0;
+
+    /**
+     * Returns true if no error occurred.
+     */
+    bool ok() const;
+
+    /**
+     * Same as ok().
+     */
+    explicit operator bool() const;
+
+    /**
+     * Formats the error message, as it would be returned by Error::what().
+     */
+    std::string message() const;
+};
+
 }
 
 std::ostream& operator<<(std::ostream& stream, const JSON::Error& error);
 
+/**
+ * Print the message of a status to a stream.
+ */
+std::ostream& operator<<(std::ostream& stream, const JSON::Status& status);
+
 #endif
\ No newline at end of file
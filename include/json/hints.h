@@ -0,0 +1,112 @@
+#ifndef _JSON_HINTS_H_
+#define _JSON_HINTS_H_
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <cstddef>
+
+namespace JSON {
+
+/**
+ * The sizes of the objects and arrays of the values parsed by a thread, learned by path, so that a value
+ * with the same shape as the previous ones has its arrays and objects allocated at their final size.
+ * The elements of an array share their path, and an object learns the paths of at most maxKeys members,
+ * so that objects used as maps with many keys do not make the hints grow without limit.
+ * While a SizeHints::Scope is alive, the values parsed by Value::parse in the current thread use and
+ * update the hints of its table, for example to parse documents of the same shape :
+ *
+ *     JSON::SizeHints hints;
+ *     JSON::SizeHints::Scope scope(hints);
+ *     for (std::istream& input : inputs) {
+ *         value.parse(input);
+ *     }
+ *
+ * The hints are not thread-safe, each thread must use its own.
+ */
+class SizeHints {
+
+public:
+
+    /**
+     * The learned size of the values at a path, and the paths of their members or elements.
+     */
+    class Node {
+
+        friend class SizeHints;
+
+        size_t size = 0;
+        std::unordered_map<std::string, std::unique_ptr<Node>> members;
+        std::unique_ptr<Node> elements;
+        SizeHints* hints;
+
+        Node(SizeHints* hints);
+
+    public:
+
+        /**
+         * Returns the size of the last value seen at this path, or 0 if there is none.
+         */
+        size_t getSize() const { return size; }
+        void setSize(size_t size) { this->size = size; }
+
+        /**
+         * Returns the node of the member with the given key, or nullptr if the object already has maxKeys members.
+         */
+        Node* getMember(const std::string& key);
+
+        /**
+         * Returns the node of the elements.
+         */
+        Node* getElements();
+    };
+
+    /**
+     * Makes the given hints the current hints of the thread until the scope is destroyed.
+     * Scopes can be nested.
+     */
+    class Scope {
+
+        SizeHints* previous;
+
+    public:
+
+        Scope(SizeHints& hints);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+
+    size_t maxKeys;
+    size_t count = 1;
+    Node root;
+
+public:
+
+    SizeHints(size_t maxKeys = 64);
+
+    SizeHints(const SizeHints&) = delete;
+    SizeHints& operator=(const SizeHints&) = delete;
+
+    /**
+     * Returns the node of the root values.
+     */
+    Node* getRoot();
+
+    /**
+     * Returns the number of paths learned.
+     */
+    size_t getCount() const;
+
+    /**
+     * Returns the hints of the current scope in this thread, or nullptr if there is no scope.
+     */
+    static SizeHints* getCurrent();
+};
+
+}
+
+#endif
\ No newline at end of file
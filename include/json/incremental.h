@@ -0,0 +1,121 @@
+#ifndef _JSON_INCREMENTAL_H_
+#define _JSON_INCREMENTAL_H_
+
+#include <json/value.h>
+#include <json/error.h>
+#include <string>
+#include <vector>
+
+namespace JSON {
+
+/**
+ * A parser for JSON text that is edited after being parsed.
+ * The byte span of every value is kept with the parsed value, so that an edit only re-parses
+ * the smallest value that encloses it, and the new value is spliced into the tree.
+ * The whole text must contain exactly one value.
+ */
+class IncrementalParser {
+
+public:
+
+    /**
+     * The position of a value in the text.
+     * The children are the spans of the values of an object or an array, in the order of the text.
+     */
+    struct Span {
+
+        /**
+         * The offset of the value relative to the beginning of the parent span.
+         * For the root span, it is the offset in the text.
+         */
+        size_t begin;
+
+        /**
+         * The length of the value in bytes.
+         */
+        size_t length;
+
+        /**
+         * The parsed value, or nullptr if it has been replaced by a later value with the same key.
+         */
+        Value* value;
+
+        std::vector<Span> children;
+    };
+
+private:
+
+    std::string text;
+    Value value;
+    Span root;
+    bool valid;
+
+    Status parseAll();
+    Status parseRegion(Value& target, Span& span, size_t begin, size_t end);
+
+public:
+
+    /**
+     * Creates a parser with an empty text.
+     */
+    IncrementalParser();
+
+    /**
+     * The spans point to the parsed value, so the parser cannot be copied.
+     */
+    IncrementalParser(const IncrementalParser&) = delete;
+    IncrementalParser& operator=(const IncrementalParser&) = delete;
+
+    /**
+     * Parses the given text, replacing the current one.
+     * Throws a Lexer::Error or a Parser::Error exception if the syntax is invalid.
+     */
+    void parse(std::string text);
+
+    /**
+     * Same as parse() but syntax errors are not thrown, they are described by the returned status.
+     */
+    Status tryParse(std::string text);
+
+    /**
+     * Replaces the given number of bytes at the given offset in the text by the inserted text,
+     * and updates the parsed value.
+     * Only the smallest value that encloses the edit is re-parsed. The spans after the edit are shifted,
+     * which does not depend on their content.
+     * Throws a Lexer::Error or a Parser::Error exception if the syntax of the new text is invalid,
+     * the next edit will then re-parse the whole text.
+     * Throws std::out_of_range if the edited bytes are not in the text.
+     */
+    void edit(size_t offset, size_t removed, const std::string& inserted);
+
+    /**
+     * Same as edit() but syntax errors are not thrown, they are described by the returned status.
+     */
+    Status tryEdit(size_t offset, size_t removed, const std::string& inserted);
+
+    /**
+     * Returns the current text.
+     */
+    const std::string& getText() const;
+
+    /**
+     * Returns the value parsed from the current text.
+     * It is undefined or incomplete if the text is invalid.
+     * The value is modified in place by the edits, so it must be copied rather than shared (see Value::share).
+     */
+    const Value& getValue() const;
+
+    /**
+     * Returns the span of the root value.
+     */
+    const Span& getSpan() const;
+
+    /**
+     * Returns true if the current text is valid.
+     */
+    bool isValid() const;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef _JSON_INPLACE_H_
+#define _JSON_INPLACE_H_
+
+#include <json/value.h>
+#include <json/error.h>
+#include <istream>
+#include <memory>
+
+namespace JSON {
+
+/**
+ * A parser that parses documents into an existing value, reusing its allocations.
+ * The value is walked alongside the parsed document : the strings are overwritten in place, keeping their
+ * capacity, the members of the objects are kept for the keys that are found again, the elements of the arrays
+ * are reused by index, and only the members and elements that no longer exist are destroyed.
+ * When documents of the same shape are parsed repeatedly with the same parser and value, the parser and the
+ * value keep their buffers between the documents and parsing does not allocate memory.
+ * The members of an object keep their order, so with JSON_HASH_OBJECT the new members come after the reused
+ * ones rather than in the order of the text. The objects and arrays that are shared (see Value::share) are
+ * copied before being modified, and the lazy ones (see Value::parseLazy) are replaced.
+ *
+ *     JSON::InPlaceParser parser;
+ *     JSON::Value value;
+ *     for (std::istream& input : inputs) {
+ *         parser.parse(value, input);
+ *     }
+ */
+class InPlaceParser {
+
+    class Handler;
+
+    std::unique_ptr<Handler> handler;
+
+public:
+
+    InPlaceParser();
+    ~InPlaceParser();
+
+    InPlaceParser(const InPlaceParser&) = delete;
+    InPlaceParser& operator=(const InPlaceParser&) = delete;
+
+    /**
+     * Parses a value from the given input stream into the given value.
+     * If an object contains multiple values with the same key, only the last one is retained.
+     * Throws a Lexer::Error or a Parser::Error exception if the syntax is invalid, the value then contains
+     * the parts of the document read before the error mixed with the previous content.
+     */
+    void parse(Value& value, std::istream& input);
+
+    /**
+     * Same as parse() but syntax errors are not thrown, they are described by the returned status.
+     */
+    Status tryParse(Value& value, std::istream& input);
+};
+
+}
+
+#endif
\ No newline at end of file
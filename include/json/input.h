@@ -0,0 +1,62 @@
+#ifndef _JSON_INPUT_H_
+#define _JSON_INPUT_H_
+
+#include <istream>
+#include <string>
+#include <memory>
+
+namespace JSON {
+
+/**
+ * An input stream that reads a file in a background thread.
+ * The reader thread fills a ring of large buffers with pread while the stream is consumed,
+ * so that the parsing thread does not wait for each read. The buffers are handed over
+ * without locks between the reader thread and the thread that reads the stream.
+ * It can be used with any function that reads from a std::istream (Value::parse, copy, check, Struct::parse, ...).
+ * A read error ends the stream like the end of the file, without throwing : Value::parse, Struct::parse and copy
+ * then throw the syntax error of the truncated document, tryParse returns it and check returns false,
+ * unless the document happens to end where the error occurred. The error is returned by getError(),
+ * which should be checked after reading to tell a read error from the end of the file.
+ * Seeking is not supported.
+ */
+class PipelinedInput : public std::istream {
+
+    class Buffer;
+
+    std::unique_ptr<Buffer> buffer;
+
+public:
+
+    /**
+     * Opens the file at the given path and starts reading it.
+     * The failbit is set if the file cannot be opened.
+     * The bufferSize parameter is the size of each buffer and bufferCount the number of buffers in the ring.
+     */
+    PipelinedInput(const std::string& file, size_t bufferSize = 1 << 20, size_t bufferCount = 4);
+
+    /**
+     * Starts reading the given file descriptor from the beginning.
+     * The file descriptor is not closed by the stream.
+     */
+    PipelinedInput(int fd, size_t bufferSize = 1 << 20, size_t bufferCount = 4);
+
+    /**
+     * Stops the reader thread and closes the file if it was opened by the stream.
+     */
+    ~PipelinedInput();
+
+    /**
+     * Returns true if the file is open.
+     */
+    bool isOpen() const;
+
+    /**
+     * Returns the errno of the read that ended the stream, or 0 if the end of the file was reached
+     * or the end of the stream has not been read yet.
+     */
+    int getError() const;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -9,4 +9,16 @@
 #include <json/printer.h>
 #include <json/utils.h>
 #include <json/value.h>
-#include <json/struct.h>
\ No newline at end of file
+#include <json/struct.h>
+#include <json/incremental.h>
+#include <json/input.h>
+#include <json/tape.h>
+#include <json/arena.h>
+#include <json/key.h>
+#include <json/document.h>
+#include <json/patch.h>
+#include <json/binary.h>
+#include <json/shared.h>
+#include <json/hints.h>
+#include <json/inplace.h>
+#include <json/reclaim.h>
\ No newline at end of file
@@ -0,0 +1,240 @@
+#ifndef _JSON_KEY_H_
+#define _JSON_KEY_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <functional>
+#include <type_traits>
+#include <cstring>
+#include <cstddef>
+
+namespace JSON {
+
+class KeyTable;
+
+/**
+ * The key of an object member.
+ * A key of up to 15 bytes is stored inline, and comparing two of them only compares two 64-bit words.
+ * A longer key points to an atom that holds the string and its hash. While a KeyTable::Scope is alive,
+ * the atoms are interned in its table : a key is stored once for the whole document and equal keys are
+ * the same pointer. Otherwise each long key owns its atom.
+ * A key converts to a std::string_view and can be compared with any string.
+ */
+class Key {
+
+public:
+
+    /**
+     * The immutable string of a long key.
+     * The table is nullptr if the atom is owned by the key.
+     */
+    struct Atom {
+        size_t hash;
+        const KeyTable* table;
+        std::string name;
+    };
+
+    /**
+     * Orders keys and strings by their content, without converting strings to keys.
+     */
+    struct Less {
+
+        using is_transparent = void;
+
+        bool operator()(const Key& first, const Key& second) const {
+            return first.view() < second.view();
+        }
+
+        template <class K>
+        bool operator()(const Key& first, const K& second) const {
+            return first.view() < std::string_view(second);
+        }
+
+        template <class K>
+        bool operator()(const K& first, const Key& second) const {
+            return std::string_view(first) < second.view();
+        }
+    };
+
+private:
+
+    static constexpr size_t inlineCapacity = 15;
+    static constexpr char atomTag = (char)0xFF;
+
+    // the characters of an inline key are followed by zeros, the last byte is inlineCapacity - size,
+    // so that it also terminates a key of 15 bytes, or atomTag if the first bytes hold a pointer to an atom
+    alignas(8) char data[16];
+
+    bool isInline() const { return data[inlineCapacity] != atomTag; }
+
+    const Atom* getAtom() const {
+        const Atom* atom;
+        memcpy(&atom, data, sizeof(atom));
+        return atom;
+    }
+
+    void setAtom(const Atom* atom);
+    void setInline(std::string_view key);
+    void create(std::string_view key);
+    void copy(const Key& key);
+    void destroy();
+
+public:
+
+    /**
+     * Creates an empty key.
+     */
+    Key() { setInline(std::string_view()); }
+
+    /**
+     * Creates a key, which is interned in the current table if it is long.
+     */
+    Key(const char* key);
+    Key(const std::string& key);
+    Key(std::string&& key);
+    Key(std::string_view key);
+
+    Key(const Key& key);
+    Key(Key&& key) noexcept;
+    ~Key() { destroy(); }
+
+    Key& operator=(const Key& key);
+    Key& operator=(Key&& key) noexcept;
+
+    /**
+     * Returns the content of the key.
+     * c_str() is terminated by a null character.
+     */
+    std::string_view view() const {
+        if (isInline()) {
+            return std::string_view(data, inlineCapacity - (unsigned char)data[inlineCapacity]);
+        }
+        return getAtom()->name;
+    }
+
+    operator std::string_view() const { return view(); }
+    const char* c_str() const { return isInline() ? data : getAtom()->name.c_str(); }
+    std::string str() const { return std::string(view()); }
+    size_t size() const { return view().size(); }
+    bool empty() const { return data[0] == '\0' && data[inlineCapacity] == (char)inlineCapacity; }
+
+    /**
+     * Returns the hash of the key, which is the same as the hash of its content (see hash(std::string_view)).
+     * The hash of a long key is computed once, when it is created.
+     */
+    size_t hash() const { return isInline() ? hash(view()) : getAtom()->hash; }
+    static size_t hash(std::string_view key) { return std::hash<std::string_view>()(key); }
+
+    /**
+     * Returns the number of bytes allocated for the key outside of it, which is 0 if it is inline or interned.
+     */
+    size_t getAllocatedSize() const;
+
+    /**
+     * Two keys are equal if they have the same content.
+     * Inline keys and interned keys of the same table are compared without reading their content.
+     */
+    bool operator==(const Key& key) const {
+        if (memcmp(data, key.data, sizeof(data)) == 0) {
+            return true;
+        }
+        if (isInline() || key.isInline()) {
+            return false;
+        }
+        const Atom* atom = getAtom();
+        const Atom* other = key.getAtom();
+        if (atom->table != nullptr && atom->table == other->table) {
+            return false;
+        }
+        return atom->hash == other->hash && atom->name == other->name;
+    }
+
+    bool operator!=(const Key& key) const { return !(*this == key); }
+    bool operator<(const Key& key) const { return view() < key.view(); }
+
+    template <class K, typename std::enable_if<std::is_convertible<const K&, std::string_view>::value && !std::is_same<K, Key>::value, int>::type = 0>
+    friend bool operator==(const Key& key, const K& other) { return key.view() == std::string_view(other); }
+
+    template <class K, typename std::enable_if<std::is_convertible<const K&, std::string_view>::value && !std::is_same<K, Key>::value, int>::type = 0>
+    friend bool operator==(const K& other, const Key& key) { return key.view() == std::string_view(other); }
+
+    template <class K, typename std::enable_if<std::is_convertible<const K&, std::string_view>::value && !std::is_same<K, Key>::value, int>::type = 0>
+    friend bool operator!=(const Key& key, const K& other) { return key.view() != std::string_view(other); }
+
+    template <class K, typename std::enable_if<std::is_convertible<const K&, std::string_view>::value && !std::is_same<K, Key>::value, int>::type = 0>
+    friend bool operator!=(const K& other, const Key& key) { return key.view() != std::string_view(other); }
+};
+
+/**
+ * A table of interned keys, usually one for a document or for an arena.
+ * While a KeyTable::Scope is alive, the long keys created in the current thread are interned in the table,
+ * for example to parse a document :
+ *
+ *     JSON::KeyTable keys;
+ *     JSON::Value value;
+ *     {
+ *         JSON::KeyTable::Scope scope(keys);
+ *         value.parse(input);
+ *     }
+ *
+ * The atoms are only released when the table is destroyed, so the keys of the table must be destroyed before it.
+ * The keys can be read by any thread, but a table is not thread-safe.
+ */
+class KeyTable {
+
+    std::vector<std::unique_ptr<Key::Atom>> atoms;
+    std::vector<const Key::Atom*> slots;
+
+    void rehash(size_t size);
+
+public:
+
+    /**
+     * Makes the given table the current table of the thread until the scope is destroyed.
+     * Scopes can be nested.
+     */
+    class Scope {
+
+        KeyTable* previous;
+
+    public:
+
+        Scope(KeyTable& table);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    KeyTable() = default;
+
+    KeyTable(const KeyTable&) = delete;
+    KeyTable& operator=(const KeyTable&) = delete;
+
+    /**
+     * Returns the atom of the given key with the given hash (see Key::hash), adding it if needed.
+     */
+    const Key::Atom* intern(std::string_view key, size_t hash);
+
+    /**
+     * Returns the number of distinct keys in the table.
+     */
+    size_t getSize() const;
+
+    /**
+     * Returns the table of the current scope in this thread, or nullptr if there is no scope.
+     */
+    static KeyTable* getCurrent();
+};
+
+}
+
+/**
+ * Prints the content of a key.
+ */
+std::ostream& operator<<(std::ostream& output, const JSON::Key& key);
+
+#endif
\ No newline at end of file
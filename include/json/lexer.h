@@ -4,12 +4,16 @@
 #include <istream>
 #include <ostream>
 #include <string>
+#include <vector>
 #include <json/error.h>
+#include <json/type.h>
+#include <cstdint>
 
 namespace JSON {
 
 /**
  * The different types of tokens that can be read.
+ * INVALID is only returned by a lexer that does not throw exceptions, when an error occurs.
  */
 enum class Token {
     OBJECT_START,
@@ -22,9 +26,12 @@ enum class Token {
     STRING,
     BOOLEAN,
     NULL_,
-    END_OF_STREAM
+    END_OF_STREAM,
+    INVALID
 };
 
+class Tape;
+
 /**
  * A JSON lexer.
  */
@@ -41,11 +48,11 @@ public:
          * The different types of lexing errors.
          */
         enum Code {
-            INVALID_CHARACTER,              // An invalid character was encountered.
-            INVALID_NUMBER,                 // A number was not correctly formatted.
-            UNTERMINATED_STRING,            // A string was not terminated before the end of the stream.
-            INVALID_ESCAPE_SEQUENCE,        // An invalid escape sequence was encountered.
-            INVALID_UNICODE_ESCAPE_SEQUENCE // An invalid unicode escape sequence was encountered.
+            INVALID_CHARACTER = Status::INVALID_CHARACTER,                            // An invalid character was encountered.
+            INVALID_NUMBER = Status::INVALID_NUMBER,                                  // A number was not correctly formatted.
+            UNTERMINATED_STRING = Status::UNTERMINATED_STRING,                        // A string was not terminated before the end of the stream.
+            INVALID_ESCAPE_SEQUENCE = Status::INVALID_ESCAPE_SEQUENCE,                // An invalid escape sequence was encountered.
+            INVALID_UNICODE_ESCAPE_SEQUENCE = Status::INVALID_UNICODE_ESCAPE_SEQUENCE // An invalid unicode escape sequence was encountered.
         };
 
         /**
@@ -64,28 +71,82 @@ public:
         int lineNumber, charPos;
 
         Error(Code code, const Lexer& lexer, char c = '\0');
+
+        /**
+         * Creates the error described by a status returned by the non-throwing API.
+         */
+        Error(const Status& status);
     };
 
 private:
 
+    /**
+     * An object or an array read from a binary input, with the number of items that remain to be read.
+     */
+    struct BinaryContainer {
+        bool object;
+        bool first;
+        uint64_t remaining;
+    };
+
+    /**
+     * What is read next from a binary input, whose separators are not in the input.
+     */
+    enum class BinaryState : unsigned char {
+        VALUE,
+        KEY,
+        COLON,
+        SEPARATOR,
+        END
+    };
+
     std::istream* input;
+    Format format = Format::TEXT;
+    std::vector<BinaryContainer> binaryContainers;
+    BinaryState binaryState;
+    const Tape* tape = nullptr;
+    Tape* recorder = nullptr;
+    size_t tapeIndex;
     int charPos, lineNumber;
     int tokenCharPos, tokenLineNumber;
+    size_t offset, tokenOffset, previousTokenEnd;
     bool carriageReturn;
+    bool exceptions = true;
+    size_t stringChunkSize = 0;
+    bool stringComplete = true;
 
     Token token;
+    Status status;
 
     double numberValue;
+    NumberType numberType;
+    int64_t integerValue;
+    uint64_t unsignedValue;
     std::string stringValue;
     bool booleanValue;
 
     void nextLine();
     char getNextChar();
   
-    void getNextNumber(char c);
-    void getNextString();
+    bool fail(Status::Code code, char c = '\0');
+
+    bool getNextNumber(char c);
+    bool getNextString();
 
     Token getNextToken();
+    Token getNextTapeToken();
+    void recordToken();
+
+    int getNextByte();
+    bool getNextBytes(char* data, size_t size);
+    bool getNextBigEndian(size_t size, uint64_t& value);
+    bool getNextBinaryString(uint64_t size);
+    Token setUnsigned(uint64_t value);
+    Token setInteger(int64_t value);
+    Token startBinaryContainer(bool object, uint64_t size);
+    Token getNextCborItem(bool key);
+    Token getNextMessagePackItem(bool key);
+    Token getNextBinaryToken();
 
 public:
 
@@ -104,12 +165,75 @@ public:
      * Reset the lexer to the initial state.
      */
     void setInput(std::istream& input);
+
+    /**
+     * Set the input stream to read from, in the given format.
+     * A binary input is read as the tokens of the equivalent JSON text, so that it can be parsed by any Parser.
+     * The integer keys of its objects are read as strings, its byte strings are read as strings, its tags are
+     * ignored and the CBOR undefined value is read as null. Its strings are always read entirely.
+     * Only the offsets are available as positions in a binary input.
+     * Reset the lexer to the initial state.
+     */
+    void setInput(std::istream& input, Format format);
+
+    /**
+     * Set a tape to replay instead of an input stream.
+     * The positions are not available when a tape is replayed.
+     * Reset the lexer to the initial state.
+     */
+    void setInput(const Tape& tape);
+
+    /**
+     * Set a tape in which the tokens read are recorded, or nullptr to stop recording.
+     * The end of the stream and the invalid tokens are not recorded.
+     */
+    void setRecorder(Tape* tape);
+
+    /**
+     * Set whether errors are thrown as Lexer::Error exceptions (the default).
+     * If not, an error makes the lexer return Token::INVALID and the error is described by getStatus().
+     */
+    void setExceptions(bool exceptions);
+
+    /**
+     * Get the status of the lexer.
+     * It describes the last error when the last token read is Token::INVALID.
+     */
+    const Status& getStatus() const;
+
+    /**
+     * Set the maximum size of the strings read at once.
+     * If it is not 0, a longer string is read in chunks of at least this size, which do not split UTF-8 sequences.
+     * The first chunk is read with the STRING token and the next ones with nextStringChunk().
+     * By default, it is 0 and strings are always read entirely.
+     */
+    void setStringChunkSize(size_t size);
+
+    /**
+     * Returns false if the last string read has other chunks to be read with nextStringChunk().
+     */
+    bool isStringComplete() const;
+
+    /**
+     * Read the next chunk of the current string, which replaces the string value.
+     * The token is not changed unless an error occurs.
+     */
+    void nextStringChunk();
     
     /**
      * Read the next token from the input stream.
      */
     void nextToken();
 
+    /**
+     * Skip the content of the object or array whose start is the last token read.
+     * The characters are only scanned for brackets and strings, the content is not checked.
+     * The items of a binary input are decoded instead.
+     * The last token becomes the matching end, or Token::END_OF_STREAM if there is none.
+     * The skipped tokens are not recorded.
+     */
+    void skipContainer();
+
     /**
      * Get the last token read from the input stream.
      * If the input stream is not set, Token::END_OF_STREAM is returned.
@@ -135,14 +259,38 @@ public:
      * Get the line number of the last token read.
      */
     int getTokenLineNumber() const;
+
+    /**
+     * Get the number of bytes read from the input stream.
+     */
+    size_t getOffset() const;
+
+    /**
+     * Get the byte offset in the input stream of the first character of the last token read.
+     */
+    size_t getTokenOffset() const;
+
+    /**
+     * Get the byte offset in the input stream just after the token read before the last one.
+     */
+    size_t getPreviousTokenEnd() const;
     
     /**
      * Get the value of the last number read.
+     * Integers are converted to the nearest double.
      */
     double getNumberValue() const;
 
     /**
-     * Get the value of the last string read.
+     * Get the representation of the last number read.
+     * The exact value of an integer is given by getIntegerValue() for INT64 and getUnsignedValue() for UINT64.
+     */
+    NumberType getNumberType() const;
+    int64_t getIntegerValue() const;
+    uint64_t getUnsignedValue() const;
+
+    /**
+     * Get the value of the last string (or string chunk) read.
      */
     const std::string& getStringValue() const;
 
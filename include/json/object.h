@@ -0,0 +1,399 @@
+#ifndef _JSON_OBJECT_H_
+#define _JSON_OBJECT_H_
+
+#include <json/arena.h>
+#include <json/key.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <tuple>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <cstdint>
+#include <type_traits>
+
+namespace JSON {
+
+/**
+ * An object backed by a vector of entries sorted by key.
+ * Lookups are binary searches in contiguous memory and iteration is in key order, like std::map.
+ * Inserting a key in the middle moves the following entries, so references to the values are not stable.
+ * The keys must not be modified through the iterators.
+ */
+template <class T>
+class FlatMap {
+
+public:
+
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = size_t;
+    using allocator_type = Allocator<value_type>;
+
+private:
+
+    using Entries = std::vector<value_type, allocator_type>;
+
+    Entries entries;
+
+    typename Entries::const_iterator lowerBound(std::string_view key) const {
+        // keys are often sorted in the input, check the end first
+        if (entries.empty() || entries.back().first.view() < key) {
+            return entries.end();
+        }
+        return std::lower_bound(entries.begin(), entries.end(), key,
+            [](const value_type& entry, std::string_view key) { return entry.first.view() < key; });
+    }
+
+public:
+
+    using iterator = typename Entries::iterator;
+    using const_iterator = typename Entries::const_iterator;
+
+    FlatMap() = default;
+
+    FlatMap(std::initializer_list<value_type> list) {
+        entries.reserve(list.size());
+        for (const value_type& entry : list) {
+            insert(entry);
+        }
+    }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    size_type size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear() { entries.clear(); }
+    void reserve(size_type count) { entries.reserve(count); }
+
+    /**
+     * Returns the number of bytes allocated for the entries, including the unused capacity.
+     */
+    size_type allocated_size() const { return entries.capacity() * sizeof(value_type); }
+
+    iterator find(std::string_view key) {
+        return begin() + (static_cast<const FlatMap&>(*this).find(key) - entries.cbegin());
+    }
+
+    const_iterator find(std::string_view key) const {
+        const_iterator it = lowerBound(key);
+        return it != end() && it->first == key ? it : end();
+    }
+
+    size_type count(std::string_view key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    T& at(std::string_view key) {
+        return const_cast<T&>(static_cast<const FlatMap&>(*this).at(key));
+    }
+
+    const T& at(std::string_view key) const {
+        const_iterator it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("key not found");
+        }
+        return it->second;
+    }
+
+    template <class K, class... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        const_iterator it = lowerBound(std::string_view(key));
+        if (it != end() && it->first == std::string_view(key)) {
+            return { begin() + (it - entries.cbegin()), false };
+        }
+        return { entries.emplace(it, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...)), true };
+    }
+
+    template <class K, class V>
+    std::pair<iterator, bool> emplace(K&& key, V&& value) {
+        return try_emplace(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& entry) {
+        return try_emplace(entry.first, entry.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& entry) {
+        return try_emplace(std::move(entry.first), std::move(entry.second));
+    }
+
+    T& operator[](const Key& key) {
+        return try_emplace(key).first->second;
+    }
+
+    T& operator[](Key&& key) {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    iterator erase(const_iterator position) {
+        return entries.erase(position);
+    }
+
+    size_type erase(std::string_view key) {
+        const_iterator it = find(key);
+        if (it == end()) {
+            return 0;
+        }
+        entries.erase(it);
+        return 1;
+    }
+
+    bool operator==(const FlatMap& map) const {
+        return entries == map.entries;
+    }
+
+    bool operator!=(const FlatMap& map) const {
+        return !(*this == map);
+    }
+};
+
+/**
+ * An object backed by a vector of entries in insertion order, indexed by an open-addressing hash table.
+ * Small objects are not indexed, their keys are compared one by one, which is faster than hashing.
+ * Iteration is in insertion order. Erasing a key rebuilds the index.
+ * Growing the object moves the entries, so references to the values are not stable.
+ * The keys must not be modified through the iterators.
+ */
+template <class T>
+class HashMap {
+
+public:
+
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = size_t;
+    using allocator_type = Allocator<value_type>;
+
+private:
+
+    using Entries = std::vector<value_type, allocator_type>;
+
+    /**
+     * A slot of the index. The index of the entry is offset by one so that 0 is an empty slot,
+     * the low bits of the hash avoid most of the key comparisons.
+     */
+    struct Slot {
+        uint32_t index;
+        uint32_t hash;
+    };
+
+    static constexpr size_type linearSize = 8;
+
+    Entries entries;
+    std::vector<Slot, Allocator<Slot>> slots;
+
+    static size_t hash(const Key& key) {
+        return key.hash();
+    }
+
+    static size_t hash(std::string_view key) {
+        return Key::hash(key);
+    }
+
+    /**
+     * The key is hashed once, keys are only compared when the low bits of their hashes are equal.
+     * A Key is compared as a key, which is faster than comparing its content.
+     */
+    template <class K>
+    size_type findIndex(const K& key) const {
+
+        if (slots.empty()) {
+            for (size_type index = 0; index < entries.size(); index++) {
+                if (entries[index].first == key) {
+                    return index;
+                }
+            }
+            return entries.size();
+        }
+
+        size_t keyHash = hash(key);
+        size_t mask = slots.size() - 1;
+
+        for (size_t i = keyHash & mask; slots[i].index != 0; i = (i + 1) & mask) {
+            if (slots[i].hash == (uint32_t)keyHash && entries[slots[i].index - 1].first == key) {
+                return slots[i].index - 1;
+            }
+        }
+
+        return entries.size();
+    }
+
+    void addSlot(size_type index) {
+        size_t keyHash = hash(entries[index].first);
+        size_t mask = slots.size() - 1;
+        size_t i = keyHash & mask;
+        while (slots[i].index != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = { (uint32_t)(index + 1), (uint32_t)keyHash };
+    }
+
+    void rehash(size_type count) {
+        if (count <= linearSize) {
+            slots.clear();
+            return;
+        }
+        size_type size = 16;
+        while (size < count * 2) {
+            size *= 2;
+        }
+        slots.assign(size, Slot{ 0, 0 });
+        for (size_type index = 0; index < entries.size(); index++) {
+            addSlot(index);
+        }
+    }
+
+public:
+
+    using iterator = typename Entries::iterator;
+    using const_iterator = typename Entries::const_iterator;
+
+    HashMap() = default;
+
+    HashMap(std::initializer_list<value_type> list) {
+        reserve(list.size());
+        for (const value_type& entry : list) {
+            insert(entry);
+        }
+    }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    size_type size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear() { entries.clear(); slots.clear(); }
+
+    /**
+     * Returns the number of bytes allocated for the entries and the index, including the unused capacity.
+     */
+    size_type allocated_size() const { return entries.capacity() * sizeof(value_type) + slots.capacity() * sizeof(Slot); }
+
+    void reserve(size_type count) {
+        entries.reserve(count);
+        if (count * 2 > slots.size()) {
+            rehash(count);
+        }
+    }
+
+    iterator find(std::string_view key) {
+        return begin() + findIndex(key);
+    }
+
+    const_iterator find(std::string_view key) const {
+        return begin() + findIndex(key);
+    }
+
+    size_type count(std::string_view key) const {
+        return findIndex(key) != entries.size() ? 1 : 0;
+    }
+
+    T& at(std::string_view key) {
+        return const_cast<T&>(static_cast<const HashMap&>(*this).at(key));
+    }
+
+    const T& at(std::string_view key) const {
+        size_type index = findIndex(key);
+        if (index == entries.size()) {
+            throw std::out_of_range("key not found");
+        }
+        return entries[index].second;
+    }
+
+    template <class K, class... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+
+        size_type index;
+        if constexpr (std::is_same<std::decay_t<K>, Key>::value) {
+            index = findIndex(key);
+        } else {
+            index = findIndex(std::string_view(key));
+        }
+        if (index != entries.size()) {
+            return { begin() + index, false };
+        }
+
+        entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+
+        if (entries.size() * 2 > slots.size()) {
+            rehash(entries.size());
+        } else {
+            addSlot(index);
+        }
+
+        return { begin() + index, true };
+    }
+
+    template <class K, class V>
+    std::pair<iterator, bool> emplace(K&& key, V&& value) {
+        return try_emplace(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& entry) {
+        return try_emplace(entry.first, entry.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& entry) {
+        return try_emplace(std::move(entry.first), std::move(entry.second));
+    }
+
+    T& operator[](const Key& key) {
+        return try_emplace(key).first->second;
+    }
+
+    T& operator[](Key&& key) {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    iterator erase(const_iterator position) {
+        iterator it = entries.erase(position);
+        rehash(entries.size());
+        return it;
+    }
+
+    size_type erase(std::string_view key) {
+        size_type index = findIndex(key);
+        if (index == entries.size()) {
+            return 0;
+        }
+        erase(begin() + index);
+        return 1;
+    }
+
+    /**
+     * Two objects are equal if they have the same keys and values, in any order.
+     */
+    bool operator==(const HashMap& map) const {
+        if (size() != map.size()) {
+            return false;
+        }
+        for (const value_type& entry : entries) {
+            size_type index = map.findIndex(entry.first);
+            if (index == map.entries.size() || !(map.entries[index].second == entry.second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const HashMap& map) const {
+        return !(*this == map);
+    }
+};
+
+}
+
+#endif
\ No newline at end of file
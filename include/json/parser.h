@@ -18,15 +18,28 @@ class Parser {
 
     Lexer lexer;
     bool delegated = false;
+    bool exceptions = true;
     size_t depth;
-    
-    void expectToken(Token expectedToken);
-
-    void parseValue(Path::Cursor& cursor);
-    void parseObject(Path::Cursor& cursor);
-    void parseNonEmptyObject(Path::Cursor& cursor);
-    void parseArray(Path::Cursor& cursor);
-    void parseNonEmptyArray(Path::Cursor& cursor, size_t index = 1);
+    size_t stringChunkSize = 0;
+    Tape* recorder = nullptr;
+    Status status;
+    std::string stringBuffer;
+    std::string keyBuffer;
+
+    bool fail();
+    bool completeString(std::string& string);
+    bool expectToken(Token expectedToken);
+
+    void reset(bool exceptions);
+    bool parseRoot(const Path& path);
+
+    bool parseValue(Path::Cursor& cursor);
+    bool parseStringChunks(Path::Cursor& cursor);
+    bool parseDelegatedValue(Path::Cursor& cursor);
+    bool parseObject(Path::Cursor& cursor);
+    bool parseNonEmptyObject(Path::Cursor& cursor);
+    bool parseArray(Path::Cursor& cursor);
+    bool parseNonEmptyArray(Path::Cursor& cursor, size_t index = 1);
 
 public:
 
@@ -46,14 +59,38 @@ public:
         int linePos, charPos;
 
         Error(const Lexer& lexer);
+
+        /**
+         * Creates the error described by a status returned by the non-throwing API.
+         */
+        Error(const Status& status);
     };
 
+    /**
+     * Throws the Lexer::Error or Parser::Error exception described by a status.
+     */
+    static void throwError(const Status& status);
+
+    /**
+     * Get the lexer used by the parser.
+     * It can be used from a callback to get the position of the current token in the input.
+     */
+    const Lexer& getLexer() const;
+
     /**
      * Get the current depth of the parser.
      * It is incremented after every call to onObjectStart or onArrayStart and decremented before onObjectEnd or onArrayEnd.
      */
     size_t getDepth() const;
 
+    /**
+     * Set the size of the chunks in which long string values are read.
+     * If it is not 0, the string values longer than this size are reported in chunks by onStringStart,
+     * onStringChunk and onStringEnd instead of onString, so that they are never entirely in memory.
+     * Object keys are always complete. By default, it is 0 and all strings are reported by onString.
+     */
+    void setStringChunkSize(size_t size);
+
     /**
      * Parse the given input stream.
      * The callbacks are called only for the content that is in the given path.
@@ -61,13 +98,40 @@ public:
      */
     void parse(std::istream& input, const Path& path = {});
 
+    /**
+     * Same as parse() but syntax errors are not thrown.
+     * Parsing stops at the first error, which is described by the returned status.
+     * Exceptions thrown by the callbacks are not caught.
+     */
+    Status tryParse(std::istream& input, const Path& path = {});
+
+    /**
+     * Same as parse() and tryParse() but the input stream is in the given format (see Lexer::setInput).
+     */
+    void parse(std::istream& input, Format format, const Path& path = {});
+    Status tryParse(std::istream& input, Format format, const Path& path = {});
+
+    /**
+     * Same as parse() and tryParse() but the tokens are replayed from a tape instead of being read from an input stream.
+     */
+    void parse(const Tape& tape, const Path& path = {});
+    Status tryParse(const Tape& tape, const Path& path = {});
+
+    /**
+     * Set a tape in which the tokens read from the input streams are recorded, or nullptr to stop recording.
+     * The tape can then be replayed by any parser, for example to parse the same input with different paths.
+     * The tape is not cleared before recording.
+     */
+    void setRecorder(Tape* tape);
+
     /**
      * Delegate the parsing of the incoming value to the given parser.
      * This can be used to parse a sub-object in a different way than the parent object.
      * This function can only be called from the callback onKey or onIndex of this parser.
      * This function must not be called while parsing is in progress in the given parser instance.
+     * Returns false if a syntax error occurred in the delegated value and this parser does not throw exceptions.
      */
-    void delegate(Parser& parser, const Path& path = {});
+    bool delegate(Parser& parser, const Path& path = {});
 
     /**
      * Callbacks that are called during parsing.
@@ -82,6 +146,21 @@ public:
     virtual void onBoolean(bool boolean) = 0;
     virtual void onString(std::string& string) = 0;
     virtual void onNull() = 0;
+
+    /**
+     * Callbacks that are called for the integers that fit in 64 bits, with their exact value.
+     * By default, the integer is converted to the nearest double and reported by onNumber.
+     */
+    virtual void onInteger(int64_t number);
+    virtual void onUnsigned(uint64_t number);
+
+    /**
+     * Callbacks that are called for the string values read in chunks (see setStringChunkSize).
+     * By default, the chunks are concatenated and the string is reported by onString.
+     */
+    virtual void onStringStart();
+    virtual void onStringChunk(std::string& chunk);
+    virtual void onStringEnd();
 };
 
 }
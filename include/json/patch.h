@@ -0,0 +1,45 @@
+#ifndef _JSON_PATCH_H_
+#define _JSON_PATCH_H_
+
+#include <json/value.h>
+#include <json/error.h>
+#include <string>
+#include <cstddef>
+
+namespace JSON {
+
+/**
+ * Exception thrown when a JSON Patch cannot be applied.
+ * The index is the position of the failing operation in the patch.
+ */
+struct PatchError : JSON::Error {
+    size_t index;
+    PatchError(size_t index, const std::string& reason);
+};
+
+/**
+ * Returns a JSON Patch (RFC 6902) that transforms the source value into the target value.
+ * The patch is an array of "add", "remove" and "replace" operations whose paths are JSON Pointers (RFC 6901).
+ * Equal subtrees are skipped without being walked if they share their content or if their hashes differ,
+ * otherwise they are compared once using their hashes (see Value::hash), so the work is proportional to the
+ * size of the values the first time and to the size of the change once the hashes are cached.
+ * Objects are compared member by member. Arrays are compared after removing their common prefix and suffix,
+ * with the shortest sequence of insertions and removals if it has at most maxArrayEdits operations,
+ * otherwise element by element.
+ * The values of the patch share their content with the target (see Value::share).
+ * Throws a Value::UndefinedValueError exception if the values contain undefined values.
+ */
+Value diff(const Value& source, const Value& target, size_t maxArrayEdits = 1024);
+
+/**
+ * Applies a JSON Patch (RFC 6902) to the given value, in place.
+ * All the operations are supported : "add", "remove", "replace", "move", "copy" and "test".
+ * A copied value shares its content with the original (see Value::share).
+ * If an operation fails, the operations before it are undone and a PatchError exception is thrown,
+ * so the value is left unchanged.
+ */
+void apply(Value& value, const Value& patch);
+
+}
+
+#endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define _JSON_PATH_CURSOR_H_
 
 #include <json/path.h>
+#include <json/key.h>
 #include <string>
 #include <vector>
 
@@ -23,6 +24,9 @@ class Path::Cursor {
     size_t diff = 0;
     size_t totalMatches = 0;
 
+    template <class T>
+    void nextStep(const T& step);
+
 public:
 
     /**
@@ -44,6 +48,7 @@ public:
      * Moves the cursor to the child of the current value with the given name or index.
      */
     void next(const std::string& name);
+    void next(const Key& name);
     void next(size_t index);
     
     /**
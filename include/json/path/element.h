@@ -2,6 +2,7 @@
 #define _JSON_PATH_ELEMENT_H_
 
 #include <json/path.h>
+#include <json/key.h>
 #include <string>
 #include <utility>
 #include <ostream>
@@ -20,6 +21,7 @@ struct Path::Element {
     virtual ~Element() = default;
 
     virtual bool accept(const std::string& name) const;
+    virtual bool accept(const Key& name) const;
     virtual bool accept(size_t index) const;
     virtual void print(std::ostream& output) const = 0;
     virtual std::unique_ptr<Element> copy() const = 0;
@@ -34,10 +36,15 @@ struct Path::Element {
 
 /**
  * An element that matches a given object key.
+ * The name is also kept as a Key, interned in the current KeyTable when the element is created,
+ * so that the keys of the same table are matched by comparing pointers. The name must not be modified.
  */
 struct Path::Element::Name : Path::Element, std::string {
+    Key key = Key(static_cast<const std::string&>(*this));
     using std::string::string;
+    Name(std::string name);
     bool accept(const std::string& name) const override;
+    bool accept(const Key& name) const override;
     void print(std::ostream& output) const override;
     std::unique_ptr<Element> copy() const override;
 };
@@ -70,6 +77,7 @@ struct Path::Element::Range : Path::Element {
 struct Path::Element::Options : Path::Element, std::pair<std::unique_ptr<Element>, std::unique_ptr<Element>> {
     using std::pair<std::unique_ptr<Element>, std::unique_ptr<Element>>::pair;
     bool accept(const std::string& name) const override;
+    bool accept(const Key& name) const override;
     bool accept(size_t index) const override;
     void print(std::ostream& output) const override;
     std::unique_ptr<Element> copy() const override;
@@ -80,6 +88,7 @@ struct Path::Element::Options : Path::Element, std::pair<std::unique_ptr<Element
  */
 struct Path::Element::Any : Path::Element {
     bool accept(const std::string& name) const override;
+    bool accept(const Key& name) const override;
     bool accept(size_t index) const override;
     void print(std::ostream& output) const override;
     std::unique_ptr<Element> copy() const override;
@@ -93,6 +102,7 @@ struct Path::Element::Any : Path::Element {
 struct Path::Element::Function : Path::Element, std::pair<std::function<bool(const std::string&)>, std::function<bool(size_t)>> {
     using std::pair<std::function<bool(const std::string&)>, std::function<bool(size_t)>>::pair;
     bool accept(const std::string& name) const override;
+    bool accept(const Key& name) const override;
     bool accept(size_t index) const override;
     void print(std::ostream& output) const override;
     std::unique_ptr<Element> copy() const override;
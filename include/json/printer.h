@@ -3,6 +3,7 @@
 
 #include <string>
 #include <ostream>
+#include <cstdint>
 
 namespace JSON {
 
@@ -21,8 +22,12 @@ class Printer {
     void printComma();
     void printTabs();
     void printString(const char* str);
+    void printStringContent(const char* str);
     void printChar(const unsigned char* str, int& i);
 
+    template <class T, class F>
+    void printValues(const T* values, size_t count, F format);
+
 public:
 
     /**
@@ -50,6 +55,7 @@ public:
      * Prints an object key.
      * Do not use this to print a string value or vice-versa.
      */
+    void key(const char* key);
     void key(const std::string& key);
 
     /**
@@ -58,8 +64,28 @@ public:
     void value(const char* value);
     void value(const std::string& value);
     void value(double value);
+    void value(int64_t value);
+    void value(uint64_t value);
     void value(bool value);
     void value();
+
+    /**
+     * Prints consecutive values of an array, as value() does for each of them.
+     * Without indentation and colors, the values are formatted in a buffer which is written in the stream at once.
+     */
+    void values(const double* values, size_t count);
+    void values(const int64_t* values, size_t count);
+    void values(const bool* values, size_t count);
+
+    /**
+     * Prints a string value in several parts.
+     * It can be used to print long strings that are not entirely in memory.
+     * The chunks must not split UTF-8 sequences if escapeUnicode is true.
+     */
+    void startString();
+    void stringChunk(const char* chunk);
+    void stringChunk(const std::string& chunk);
+    void endString();
 };
 
 }
@@ -0,0 +1,117 @@
+#ifndef _JSON_RECLAIM_H_
+#define _JSON_RECLAIM_H_
+
+#include <json/value.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+namespace JSON {
+
+/**
+ * A queue of values to destroy later, so that dropping a large value does not free all its strings,
+ * objects and arrays in the thread that drops it. A retired value is destroyed by a background thread,
+ * or by the owner of the reclaimer calling reclaim() with a budget, for example between two requests.
+ * The destruction is iterative : the objects and arrays of a retired value are queued one by one,
+ * so that each call to reclaim() does a bounded amount of work whatever the depth of the value.
+ * While a Reclaimer::Scope is alive, the large objects and arrays destroyed or replaced in the current thread
+ * (by the destructor, operator= or clear() of their value) are retired instead, for example :
+ *
+ *     JSON::Reclaimer reclaimer;
+ *     JSON::Reclaimer::Scope scope(reclaimer);
+ *     value.parse(input); // the previous document is destroyed by the reclaimer thread
+ *
+ * Only the values allocated with the default memory resource are retired by a scope, since an arena is
+ * usually destroyed right after its values (see Arena). The key tables of the retired values
+ * (see KeyTable) must outlive their destruction, which wait() guarantees.
+ * A reclaimer is thread-safe.
+ */
+class Reclaimer {
+
+    size_t minSize;
+    bool background;
+    bool stopped = false;
+    size_t busy = 0;
+    std::vector<Value> pending;
+    mutable std::mutex mutex;
+    std::condition_variable retired;
+    std::condition_variable idle;
+    std::thread thread;
+
+    void run();
+
+public:
+
+    /**
+     * Makes the given reclaimer the current reclaimer of the thread until the scope is destroyed.
+     * Scopes can be nested.
+     */
+    class Scope {
+
+        Reclaimer* previous;
+
+    public:
+
+        Scope(Reclaimer& reclaimer);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /**
+     * Creates a reclaimer, which destroys the retired values in its own thread if background is true,
+     * or only when reclaim() is called otherwise.
+     * A scope retires the objects and arrays that have at least minSize members or elements,
+     * the smaller ones are cheaper to destroy than to queue.
+     */
+    Reclaimer(bool background = true, size_t minSize = 256);
+
+    /**
+     * Destroys all the pending values, then stops the background thread.
+     */
+    ~Reclaimer();
+
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator=(const Reclaimer&) = delete;
+
+    /**
+     * Queues the given value for destruction, leaving it undefined, in constant time.
+     */
+    void retire(Value&& value);
+
+    /**
+     * Destroys pending values in the calling thread until about budget strings, objects, arrays,
+     * members and elements are freed or the queue is empty, and returns the number freed.
+     * The budget can be exceeded by the size of one object or array.
+     */
+    size_t reclaim(size_t budget = SIZE_MAX);
+
+    /**
+     * Waits until all the values retired so far are destroyed.
+     * Without a background thread, destroys them in the calling thread.
+     */
+    void wait();
+
+    /**
+     * Returns the number of values, objects and arrays waiting to be destroyed.
+     */
+    size_t getPendingCount() const;
+
+    /**
+     * Returns the minimum size of the objects and arrays retired by a scope.
+     */
+    size_t getMinSize() const;
+
+    /**
+     * Returns the reclaimer of the current scope in this thread, or nullptr if there is no scope.
+     */
+    static Reclaimer* getCurrent();
+};
+
+}
+
+#endif
\ No newline at end of file
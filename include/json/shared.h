@@ -0,0 +1,140 @@
+#ifndef _JSON_SHARED_H_
+#define _JSON_SHARED_H_
+
+#include <json/value.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace JSON {
+
+/**
+ * A value read by many threads and replaced from time to time, with read-copy-update semantics.
+ * A reader gets an immutable snapshot of the current value without taking a lock : it only writes the
+ * current epoch in a reader slot and reads the published pointer. A writer publishes a new value with one
+ * atomic exchange, and the replaced value is destroyed once no reader that started before the exchange
+ * holds it. The writers are serialized by a mutex, which the readers only take if all the reader slots are used.
+ * The published values are shared (see Value::share), so copying a snapshot is cheap and update() only
+ * copies the strings, objects and arrays on the path to the modified values.
+ * The published values must not be lazy, since reading a lazy value modifies it (see Value::parseLazy).
+ * The replaced values are destroyed by the writers, or by a reclaimer while a Reclaimer::Scope is alive in the
+ * writing thread, so that replacing a large value does not delay the writer.
+ */
+class SharedValue {
+
+    /**
+     * The epoch in which a reader started, or 0 if the slot is free.
+     * The slots are on separate cache lines so that the readers do not contend.
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{ 0 };
+    };
+
+    /**
+     * A replaced value and the epoch in which it was replaced.
+     */
+    struct Retired {
+        const Value* value;
+        uint64_t epoch;
+    };
+
+    std::atomic<const Value*> current;
+    std::atomic<uint64_t> epoch{ 1 };
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount;
+    mutable std::mutex writer;
+    std::vector<Retired> retired;
+
+    Slot* acquireSlot() const;
+    void publish(Value&& value);
+    void reclaim();
+
+public:
+
+    /**
+     * A snapshot of the value, which stays valid and unchanged while the snapshot is alive.
+     * A snapshot must be destroyed before the SharedValue.
+     * Keeping a snapshot delays the destruction of the values replaced after it was taken, so a value that is
+     * used for a long time should be copied instead, which shares its content.
+     */
+    class Snapshot {
+
+        friend class SharedValue;
+
+        const Value* value;
+        Slot* slot;
+        Value copy;
+
+        Snapshot(const Value* value, Slot* slot);
+        Snapshot(Value&& copy);
+
+    public:
+
+        Snapshot(Snapshot&& snapshot) noexcept;
+        Snapshot& operator=(Snapshot&& snapshot) noexcept;
+        ~Snapshot();
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        const Value& operator*() const { return *value; }
+        const Value* operator->() const { return value; }
+    };
+
+    /**
+     * Creates a shared value holding the given value.
+     * The number of slots is the number of snapshots that can be held at the same time without locking,
+     * a reader that finds no free slot copies the current value while holding the writers' mutex instead.
+     */
+    SharedValue(Value value = Value(), size_t slotCount = 128);
+
+    /**
+     * Destroys the current value and the replaced ones. No snapshot must be alive.
+     */
+    ~SharedValue();
+
+    SharedValue(const SharedValue&) = delete;
+    SharedValue& operator=(const SharedValue&) = delete;
+
+    /**
+     * Returns a snapshot of the current value.
+     */
+    Snapshot read() const;
+
+    /**
+     * Returns a copy of the current value, which shares its content.
+     */
+    Value load() const;
+
+    /**
+     * Publishes a new value, which is shared.
+     * The replaced values that are no longer read are destroyed.
+     */
+    void store(Value value);
+
+    /**
+     * Publishes a modified copy of the current value : the function is called with a copy that shares the
+     * content of the current value, and can modify it in place. The writers are blocked until it returns.
+     * If the function throws an exception, nothing is published.
+     */
+    template <class F>
+    void update(F function) {
+        std::lock_guard<std::mutex> lock(writer);
+        Value value = *current.load(std::memory_order_acquire);
+        function(value);
+        publish(std::move(value));
+    }
+
+    /**
+     * Returns the number of replaced values that are still held by snapshots.
+     */
+    size_t getRetiredCount();
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -4,9 +4,11 @@
 #include <json/type.h>
 #include <json/parser.h>
 #include <json/path.h>
+#include <json/tape.h>
 #include <vector>
 #include <istream>
 #include <cstddef>
+#include <cstdint>
 
 namespace JSON {
 
@@ -26,10 +28,23 @@ public:
      * The field pointer is the pointer to the field in the struct.
      * The count is the number of times the field has been found.
      * The type is the type of the value : NUMBER, BOOLEAN, STRING or NULL_.
-     * The value is the value to set : double* for NUMBER, bool* for BOOLEAN, std::string* for STRING and nullptr for NULL_.
+     * The value is the value to set : NumberValue* for NUMBER (which can be read as a double*), bool* for BOOLEAN,
+     * std::string* for STRING and nullptr for NULL_.
      */
     using PrimitiveSetter = bool (*)(void* field, int count, Type type, void* value);
 
+    /**
+     * The value given to a primitive setter for a number.
+     * The first member is the number converted to a double, the exact value of an integer is given by
+     * integerValue or unsignedValue according to the type.
+     */
+    struct NumberValue {
+        double value;
+        NumberType type;
+        int64_t integerValue;
+        uint64_t unsignedValue;
+    };
+
     /**
      * A function that sets a default value for a field in a struct.
      */
@@ -104,11 +119,17 @@ public:
 
     /**
      * A setter for numbers (int, long, float, double, ...).
+     * Integers are converted from their exact value.
      */
-    template<typename NumberType>
+    template<typename T>
     static bool NUMBER(void* field, int count, Type type, void* value) {
         if (type == Type::NUMBER) {
-            *(NumberType*)field = (NumberType)(*(double*)value);
+            const NumberValue& number = *(const NumberValue*)value;
+            switch (number.type) {
+                case NumberType::INT64: *(T*)field = (T)number.integerValue; break;
+                case NumberType::UINT64: *(T*)field = (T)number.unsignedValue; break;
+                default: *(T*)field = (T)number.value; break;
+            }
             return true;
         }
         return false;
@@ -148,6 +169,22 @@ public:
      * The base pointer is the pointer to the structure to be filled.
      */
     void parse(void* base, std::istream& input, const Path& path = {});
+
+    /**
+     * Same as parse() but syntax errors are not thrown, they are described by the returned status.
+     * The default setters are not called if an error occurs.
+     */
+    Status tryParse(void* base, std::istream& input, const Path& path = {});
+
+    /**
+     * Same as parse() but the tokens are replayed from a tape.
+     */
+    void parse(void* base, const Tape& tape, const Path& path = {});
+
+    /**
+     * Same as parse() but the input stream is in the given format (see Lexer::setInput).
+     */
+    void parse(void* base, std::istream& input, Format format, const Path& path = {});
 };
 
 }
@@ -0,0 +1,114 @@
+#ifndef _JSON_TAPE_H_
+#define _JSON_TAPE_H_
+
+#include <json/lexer.h>
+#include <json/error.h>
+#include <json/type.h>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+
+namespace JSON {
+
+/**
+ * A compact recording of the tokens of a JSON input.
+ * Each token is a 64-bit word that contains its type and an offset in a buffer that holds the decoded strings and numbers.
+ * A tape can be replayed by any Parser (see Parser::parse) without lexing the input again,
+ * and it can be saved to a file to be loaded later.
+ */
+class Tape {
+
+    std::vector<uint64_t> tokens;
+    std::string data;
+
+    void append(Token token, uint64_t payload = 0);
+    uint64_t getPayload(size_t index) const;
+
+public:
+
+    /**
+     * Creates an empty tape.
+     */
+    Tape() = default;
+
+    /**
+     * Creates a tape recorded from the given input stream (see record).
+     */
+    Tape(std::istream& input);
+
+    /**
+     * Records the tokens of the given input stream, replacing the content of the tape.
+     * The syntax of the input is checked so that the tape always contains a valid JSON value.
+     * Throws a Lexer::Error or a Parser::Error exception if the syntax is invalid.
+     */
+    void record(std::istream& input);
+
+    /**
+     * Same as record() but syntax errors are not thrown, they are described by the returned status.
+     * The tape is empty if an error occurs.
+     */
+    Status tryRecord(std::istream& input);
+
+    /**
+     * Removes all the tokens from the tape.
+     */
+    void clear();
+
+    /**
+     * Appends a token to the tape.
+     * The value of a NUMBER, STRING or BOOLEAN token is given by the other functions.
+     * appendInteger and appendUnsigned append a NUMBER token that keeps the exact value of an integer.
+     * appendStringChunk appends a string to the last string of the tape.
+     */
+    void appendToken(Token token);
+    void appendNumber(double value);
+    void appendInteger(int64_t value);
+    void appendUnsigned(uint64_t value);
+    void appendString(std::string_view value);
+    void appendStringChunk(std::string_view chunk);
+    void appendBoolean(bool value);
+
+    /**
+     * Returns the number of tokens in the tape.
+     */
+    size_t getSize() const;
+
+    /**
+     * Returns the token at the given index.
+     */
+    Token getToken(size_t index) const;
+
+    /**
+     * Returns the value of the token at the given index.
+     * The token must have the corresponding type.
+     * getNumberValue converts integers to the nearest double, getIntegerValue and getUnsignedValue return 0
+     * if the number does not have the corresponding representation (see getNumberType).
+     */
+    NumberType getNumberType(size_t index) const;
+    double getNumberValue(size_t index) const;
+    int64_t getIntegerValue(size_t index) const;
+    uint64_t getUnsignedValue(size_t index) const;
+    std::string_view getStringValue(size_t index) const;
+    bool getBooleanValue(size_t index) const;
+
+    /**
+     * Writes the tape to a binary stream.
+     * The format depends on the endianness of the machine.
+     */
+    void save(std::ostream& output) const;
+
+    /**
+     * Reads a tape written by save() from a binary stream.
+     * Throws std::runtime_error if the stream does not contain a valid tape. The sizes of the header are checked
+     * against the rest of the stream if it can be sought, otherwise the content is read in chunks, so a corrupted
+     * header never allocates more than the stream contains.
+     */
+    void load(std::istream& input);
+};
+
+}
+
+#endif
\ No newline at end of file
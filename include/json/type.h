@@ -17,6 +17,27 @@ enum class Type {
     ARRAY
 };
 
+/**
+ * Enum for the different representations of a number.
+ * Integers that fit in 64 bits are read as INT64 (or UINT64 if they are too large for INT64),
+ * the other numbers are DOUBLE.
+ */
+enum class NumberType : unsigned char {
+    DOUBLE,
+    INT64,
+    UINT64
+};
+
+/**
+ * Enum for the formats in which JSON data can be read and written.
+ * CBOR (RFC 8949) and MessagePack are binary formats that can represent the same data as JSON text.
+ */
+enum class Format : unsigned char {
+    TEXT,
+    CBOR,
+    MESSAGEPACK
+};
+
 }
 
 #endif
\ No newline at end of file
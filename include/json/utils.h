@@ -2,6 +2,8 @@
 #define _JSON_UTILS_H_
 
 #include <json/path.h>
+#include <json/tape.h>
+#include <json/type.h>
 #include <istream>
 #include <ostream>
 
@@ -17,6 +19,18 @@ namespace JSON {
  */
 void copy(std::ostream& output, std::istream& input, int ident = 0, bool escapeUnicode = true, const Path& path = {});
 
+/**
+ * Same as copy() but the tokens are replayed from a tape.
+ */
+void copy(std::ostream& output, const Tape& tape, int ident = 0, bool escapeUnicode = true, const Path& path = {});
+
+/**
+ * Copies data from an input stream in a format to an output stream in another format (see Format).
+ * The syntax is checked, and JSON text is written without indentation.
+ * If path is not empty, only the values in the path are copied.
+ */
+void transcode(std::ostream& output, Format outputFormat, std::istream& input, Format inputFormat, const Path& path = {});
+
 /**
  * Reads JSON data from an input stream and checks the syntax.
  */
@@ -2,55 +2,163 @@
 #define _JSON_VALUE_H_
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <cstdint>
+#include <type_traits>
 #include <istream>
 #include <ostream>
+#include <memory>
+#include <functional>
 #include <json/type.h>
 #include <json/error.h>
 #include <json/printer.h>
+#include <json/binary.h>
 #include <json/path.h>
 #include <json/path/cursor.h>
+#include <json/tape.h>
+#include <json/arena.h>
+#include <json/key.h>
+#include <json/object.h>
 
 namespace JSON {
 
 class Value;
+class Reclaimer;
 
 /**
  * Alias for the different JSON value types.
+ * Objects and arrays are allocated with the current memory resource of the thread (see Arena).
+ * The keys of objects are Key, which can be interned in a KeyTable.
+ * By default, objects are sorted maps. The library and the code that uses it can instead be compiled with
+ * JSON_FLAT_OBJECT to use a sorted vector (see FlatMap) or with JSON_HASH_OBJECT to use a hash table
+ * that keeps the insertion order (see HashMap).
  */
 using Number = double;
+using Integer = int64_t;
+using Unsigned = uint64_t;
 using Boolean = bool;
 using String = std::string;
 using Null = std::nullptr_t;
-using Object = std::map<std::string, Value>;
-using Array = std::vector<Value>;
+#if defined(JSON_FLAT_OBJECT)
+using Object = FlatMap<Value>;
+#elif defined(JSON_HASH_OBJECT)
+using Object = HashMap<Value>;
+#else
+using Object = std::map<Key, Value, Key::Less, Allocator<std::pair<const Key, Value>>>;
+#endif
+using Array = std::vector<Value, Allocator<Value>>;
 
 /**
  * The null value.
  */
 static constexpr const Null null = Null();
 
+/**
+ * A read-only view of contiguous elements, such as the elements of a packed array (see Value::pack).
+ */
+template <class T>
+class Span {
+
+    T* first;
+    size_t count;
+
+public:
+
+    Span(T* data = nullptr, size_t size = 0) : first(data), count(size) {}
+
+    T* data() const { return first; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T* begin() const { return first; }
+    T* end() const { return first + count; }
+    T& operator[](size_t index) const { return first[index]; }
+};
+
 /**
  * A JSON value.
+ * Strings, objects and arrays are stored in a separate block, so that a value only takes 16 bytes.
+ * Moving a value moves the pointer to the block, the moved value becomes undefined.
+ * An array whose elements are all numbers of the same representation or all booleans can be packed,
+ * its elements are then stored contiguously without their type (see pack).
  */
 class Value {
 
+    friend class Reclaimer;
+
+    template <class T>
+    struct Block;
+
+    struct Lazy;
+    struct Packed;
+    struct MemoryMeter;
+
     union {
         Number numberValue;
+        Integer integerValue;
+        Unsigned unsignedValue;
         Boolean booleanValue;
         Null nullValue;
-        String stringValue;
-        Object objectValue;
-        Array arrayValue;
+        Block<String>* stringBlock;
+        Block<Object>* objectBlock;
+        Block<Array>* arrayBlock;
+        Block<Lazy>* lazyBlock;
+        Block<Packed>* packedBlock;
     };
 
     Type type;
+    NumberType numberType;
+    bool lazy = false;
+    bool packed = false;
+
+    template <class T, class... Args>
+    static Block<T>* createBlock(Args&&... args);
 
+    template <class T>
+    static Block<T>* copyBlock(Block<T>* block);
+
+    template <class T>
+    static void destroyBlock(Block<T>* block);
+
+    template <class T>
+    static bool isUnique(const Block<T>* block);
+
+    template <class T>
+    static bool isImmutable(const Block<T>* block);
+
+    template <class T, class F>
+    static size_t getCachedHash(Block<T>* block, F compute);
+
+    template <class T>
+    static bool equalBlocks(const Block<T>* first, const Block<T>* second);
+
+    void markShared() const;
+    void detach();
+    void resetHash();
+
+    static Value createLazy(Type type, const std::shared_ptr<const std::string>& source, size_t begin, size_t size);
+    void materialize() const;
+    void unpack();
+    bool equalArrays(const Value& value) const;
+
+    template <class P>
+    void printTo(P& printer) const;
+
+    template <class P>
+    void printPacked(P& printer) const;
+
+    void measure(MemoryMeter& meter) const;
+
+    bool retire();
+    size_t release(std::vector<Value>& children);
+    void destroyValue();
     void clearValue();
+    void assignNumber(const Value& value);
     void assignValue(const Value& value);
     void assignValue(Value&& value);
 
+    Value* findFirst(Path::Cursor& cursor);
     const Value* findFirst(Path::Cursor& cursor) const;
 
     void findAll(std::vector<Value*>& all, Path::Cursor& cursor);
@@ -82,6 +190,15 @@ public:
         UndefinedValueError();
     };
 
+    /**
+     * Exception thrown when a number cannot be represented exactly as the requested integer type, or when a
+     * reference to a number is requested with another representation than the stored one.
+     */
+    struct NumberConversionError : JSON::Error {
+        NumberType type;
+        NumberConversionError(NumberType type);
+    };
+
     /**
      * Creates an undefined value.
      */
@@ -91,12 +208,25 @@ public:
      * Creates a value from another value.
      */
     Value(const Value& value);
-    Value(Value&& value);
+    Value(Value&& value) noexcept;
 
     /**
      * Creates a value from a primitive value.
+     * Integers are stored exactly, as INT64 if they are in its range and as UINT64 otherwise, like parsed integers.
      */
     Value(Number value);
+    Value(Integer value);
+    Value(Unsigned value);
+
+    template <class T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    Value(T value) : type(Type::UNDEFINED) {
+        if constexpr (std::is_signed<T>::value) {
+            setIntegerValue(value);
+        } else {
+            *this = (Unsigned)value;
+        }
+    }
+
     Value(Boolean value);
     Value(Null value);
     Value(const String& value);
@@ -123,6 +253,15 @@ public:
     void assign(const Value& value);
     void assign(Value&& value);
 
+    /**
+     * Returns a copy of the value that shares its content instead of copying it.
+     * The shared content is copied on write : modifying one of the copies (through a non-const method)
+     * only copies the strings, objects and arrays from the root to the modified value, the others stay shared.
+     * All the copies of a shared value are shared too. The copies can be used by different threads.
+     * References obtained from a non-const method before sharing must not be used to modify the value after.
+     */
+    Value share() const;
+
     /**
      * Returns the type of the value.
      */
@@ -138,17 +277,81 @@ public:
      */
     bool isUndefined() const;
 
+    /**
+     * Returns true if the value is an object or an array whose content is not parsed yet (see parseLazy).
+     */
+    bool isLazy() const;
+
+    /**
+     * Returns true if the value is a packed array (see pack).
+     * The second version also checks the type of the elements, and their representation for numbers.
+     */
+    bool isPacked() const;
+    bool isPacked(Type type, NumberType numberType = NumberType::DOUBLE) const;
+
+    /**
+     * Packs an array whose elements are all DOUBLE numbers, all INT64 numbers or all booleans : the elements are
+     * stored contiguously as 8 bytes numbers or 1 byte booleans instead of 16 bytes values, and can be read
+     * as a Span with getNumberSpan, getIntegerSpan or getBooleanSpan. Arrays of at least packedMinSize such
+     * elements are packed by parse(). The content of a packed array is immutable : the non-const getters
+     * unpack it. The library reads packed arrays through their elements (findFirst, findAll, diff, Document,
+     * print, comparisons and hashes), but the const getArrayValue and operator[], which return references,
+     * are only kept for compatibility : they build an array of values on first use and keep it with the packed
+     * elements until the array is destroyed, which takes the memory of both, so callers should read packed
+     * arrays with the spans, getArraySize and getElement instead.
+     * Returns true if the array is packed, false if the value is not an array or its elements cannot be packed.
+     */
+    bool pack();
+
+    /**
+     * The minimum number of elements of the arrays packed by parse().
+     */
+    static constexpr size_t packedMinSize = 16;
+
+    /**
+     * Returns the elements of a packed array of the given type.
+     * Throws a TypeAssertionError exception if the value is not an array packed with elements of this type.
+     */
+    Span<const Number> getNumberSpan() const;
+    Span<const Integer> getIntegerSpan() const;
+    Span<const Boolean> getBooleanSpan() const;
+
+    /**
+     * Returns the number of elements of an array, and a copy of the element at the given index,
+     * without building the array of values of a packed array (see pack).
+     * Throws a TypeAssertionError exception if the value is not an array.
+     * Throws a KeyError exception if the index is out of bounds.
+     */
+    size_t getArraySize() const;
+    Value getElement(size_t index) const;
+
     /**
      * Throws a TypeAssertionError exception if the value is not of the given type.
      */
     void assertType(Type type) const;
 
+    /**
+     * Returns the representation of a number value.
+     * Throws a TypeAssertionError exception if the value is not a number.
+     */
+    NumberType getNumberType() const;
+
     /**
      * Returns the value as the given type.
      * Throws a TypeAssertionError exception if the value is not of the given type.
+     * A number can be read with any representation : getNumberValue converts an integer to the nearest double,
+     * getIntegerValue and getUnsignedValue throw a NumberConversionError exception if the number is not an integer
+     * in the range of the type. The non-const versions return a reference to the stored number, which reading
+     * never converts, so they throw a NumberConversionError exception if the number is stored with another
+     * representation (see getNumberType) : a number is converted by reading it from a const value, and its
+     * representation is changed with setNumberValue, setIntegerValue or setUnsignedValue.
      */
     Number& getNumberValue();
     Number getNumberValue() const;
+    Integer& getIntegerValue();
+    Integer getIntegerValue() const;
+    Unsigned& getUnsignedValue();
+    Unsigned getUnsignedValue() const;
     Boolean& getBooleanValue();
     Boolean getBooleanValue() const;
     Null& getNullValue();
@@ -164,6 +367,8 @@ public:
      * Sets the value to the given value.
      */
     void setNumberValue(Number value = Number());
+    void setIntegerValue(Integer value = Integer());
+    void setUnsignedValue(Unsigned value = Unsigned());
     void setBooleanValue(Boolean value = Boolean());
     void setNullValue(Null value = Null());
     void setStringValue(const String& value);
@@ -185,6 +390,18 @@ public:
      * Returns a reference to the this value.
      */
     Value& operator=(Number value);
+    Value& operator=(Integer value);
+    Value& operator=(Unsigned value);
+
+    template <class T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    Value& operator=(T value) {
+        if constexpr (std::is_signed<T>::value) {
+            setIntegerValue(value);
+        } else {
+            *this = (Unsigned)value;
+        }
+        return *this;
+    }
     Value& operator=(Boolean value);
     Value& operator=(Null value);
     Value& operator=(const String& value);
@@ -206,6 +423,7 @@ public:
      * Returns the value at the given index for an array.
      * Throws a TypeAssertionError exception if the value is not an array.
      * Throws a KeyError exception if the key is not found.
+     * The const version builds the array of values of a packed array (see pack), getElement does not.
      */
     Value& operator[](size_t index);
     const Value& operator[](size_t index) const;
@@ -214,15 +432,78 @@ public:
      * Compares two values.
      * If the values are not of the same type, they are considered different.
      * If the values have the same type, they are compared using the comparison operators for their primitive values.
+     * Numbers are equal if they have exactly the same value, whatever their representation.
+     * Values that share their content (see share) are equal without being compared, and shared strings, objects
+     * and arrays whose hashes are cached and different are not equal without being compared (see hash).
      */
     bool operator==(const Value& value) const;
     bool operator!=(const Value& value) const;
 
+    /**
+     * Returns a hash of the value, so that equal values have the same hash.
+     * Numbers are hashed by their value whatever their representation, and the keys of an object in any order.
+     * The hash of a string, an object or an array is cached with its content while it is shared by several values
+     * (see share), which cannot modify it in place, so hashing a shared value again only reads the root.
+     * Throws an UndefinedValueError exception if the value or one of its children is undefined.
+     */
+    size_t hash() const;
+
+    /**
+     * The memory used by a value, in bytes, by category :
+     * - nodes : the blocks of the strings, objects and arrays, the elements of the arrays, the members of the
+     *   objects and the indexes of the hash objects. The nodes of std::map are estimated as 4 pointers each.
+     * - strings : the characters of the strings that are not stored in their block, and the text of lazy values.
+     * - keys : the long keys owned by the objects. Interned keys are owned by their KeyTable and not counted.
+     * - slack : the unused capacity of the strings, the arrays and the flat or hash objects.
+     * shared is the part of the total that is shared with other values (see share()), which is counted once.
+     */
+    struct MemoryUsage {
+
+        size_t nodes = 0;
+        size_t strings = 0;
+        size_t keys = 0;
+        size_t slack = 0;
+        size_t shared = 0;
+
+        /**
+         * Returns the sum of the categories.
+         */
+        size_t getTotal() const;
+    };
+
+    /**
+     * The memory used by a string, an object or an array in a value, and its path (see getHeaviestSubtrees()).
+     */
+    struct SubtreeUsage {
+        std::string path;
+        MemoryUsage usage;
+    };
+
+    /**
+     * Returns the memory used by the content of the value, which does not include the 16 bytes of the value itself.
+     * The value is walked once, without parsing lazy values or modifying it.
+     */
+    MemoryUsage getMemoryUsage() const;
+
+    /**
+     * Returns the given number of strings, objects and arrays that use the most memory with their content,
+     * heaviest first, with their paths in the syntax of Path (for example $.['a'].[0]).
+     * The usage of a subtree includes its children, so the ancestors of a heavy subtree are usually reported too.
+     * The value is walked once as in getMemoryUsage(), and the paths are only built for the heaviest subtrees.
+     */
+    std::vector<SubtreeUsage> getHeaviestSubtrees(size_t count) const;
+
     /**
      * Prints the value using the given printer.
      */
     void print(Printer& printer) const;
 
+    /**
+     * Prints the value in a binary format using the given printer.
+     * The sizes of the objects and arrays are written in their headers.
+     */
+    void print(BinaryPrinter& printer) const;
+
     /**
      * Creates a printer with the given parameters and prints the value.
      */
@@ -238,6 +519,59 @@ public:
      */
     void parse(std::istream& input, const Path& path = {}, bool unique = true);
 
+    /**
+     * Same as parse() but syntax errors are not thrown, they are described by the returned status.
+     * If an error occurs, the value contains what was parsed before the error.
+     */
+    Status tryParse(std::istream& input, const Path& path = {}, bool unique = true);
+
+    /**
+     * Same as parse() but the tokens are replayed from a tape.
+     */
+    void parse(const Tape& tape, const Path& path = {}, bool unique = true);
+
+    /**
+     * Same as parse() but the input stream is in the given format (see Lexer::setInput).
+     */
+    void parse(std::istream& input, Format format, const Path& path = {}, bool unique = true);
+
+    /**
+     * Same as parse() but the text is in memory. Without a path, the text is first scanned to count the values
+     * of its objects and arrays, so that they are allocated at their final size.
+     */
+    void parse(std::string_view text, const Path& path = {}, bool unique = true);
+
+    /**
+     * Parses a value from the given text without building its objects and arrays.
+     * The text is kept with the value and each object or array only records its position in the text.
+     * Its content is parsed on first access (by the getters, operator[], findFirst, findAll, print or a comparison),
+     * its children objects and arrays staying unparsed in turn. A part of the text that is never accessed
+     * is only scanned once for brackets and strings, so its syntax is not checked.
+     * Throws a Lexer::Error or a Parser::Error exception if the syntax is invalid, which can happen on first access.
+     * The positions of such errors are relative to the start of the object or array.
+     * Accessing a lazy value modifies it, even through a const reference, so it must not be read by
+     * different threads at the same time, including through shared copies.
+     */
+    void parseLazy(std::string text);
+
+    /**
+     * Applies a JSON Merge Patch (RFC 7396) to the value, in place.
+     * If the patch is an object, its members are merged recursively into the value, which becomes an object if it
+     * is not one, and the members set to null are removed. Otherwise the value is replaced by the patch.
+     * The members of an rvalue patch are moved instead of being copied : the entries of a std::map are moved
+     * without being reallocated if both objects use the same memory resource.
+     */
+    void mergePatch(const Value& patch);
+    void mergePatch(Value&& patch);
+
+    /**
+     * Same as mergePatch() but the patch is parsed from the given input stream and applied while it is read,
+     * without being stored in a value.
+     * Throws a Lexer::Error or a Parser::Error exception if the syntax is invalid,
+     * the value then contains the members patched before the error.
+     */
+    void mergePatch(std::istream& input);
+
     /**
      * Finds the first sub-value matching the given path.
      * Returns nullptr if no value is found.
@@ -264,6 +598,20 @@ Value load(const std::string& file, const Path& path = {}, bool unique = true);
 
 }
 
+/**
+ * Hashes a value using Value::hash(), so that values can be used as keys of unordered containers.
+ */
+namespace std {
+
+template <>
+struct hash<JSON::Value> {
+    size_t operator()(const JSON::Value& value) const {
+        return value.hash();
+    }
+};
+
+}
+
 /**
  * Prints the name of the given type.
  */
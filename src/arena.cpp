@@ -0,0 +1,113 @@
+#include <json/arena.h>
+#include <new>
+#include <algorithm>
+#include <cstdint>
+#include <sys/mman.h>
+
+namespace JSON {
+
+static const size_t hugePageSize = 2 << 20;
+
+static thread_local std::pmr::memory_resource* currentResource = nullptr;
+
+Arena::Scope::Scope(std::pmr::memory_resource& resource) : previous(currentResource) {
+    currentResource = &resource;
+}
+
+Arena::Scope::~Scope() {
+    currentResource = previous;
+}
+
+std::pmr::memory_resource* Arena::getCurrent() {
+    return currentResource != nullptr ? currentResource : std::pmr::new_delete_resource();
+}
+
+Arena::Arena(size_t chunkSize, bool hugePages) :
+    chunkSize(chunkSize > 0 ? chunkSize : 1), hugePages(hugePages), current(nullptr), end(nullptr), used(0) {}
+
+Arena::~Arena() {
+    release();
+}
+
+Arena::Chunk Arena::allocateChunk(size_t size) {
+
+    if (hugePages) {
+        size = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(data, size, MADV_HUGEPAGE);
+#endif
+        return { static_cast<char*>(data), size };
+    }
+
+    return { static_cast<char*>(::operator new(size)), size };
+}
+
+void Arena::deallocateChunk(const Chunk& chunk) {
+    if (hugePages) {
+        munmap(chunk.data, chunk.size);
+    } else {
+        ::operator delete(chunk.data);
+    }
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+
+    size_t padding = -reinterpret_cast<uintptr_t>(current) & (alignment - 1);
+
+    if (current == nullptr || (size_t)(end - current) < padding + bytes) {
+
+        // large allocations get their own chunk so that the current one is not wasted
+        if (bytes + alignment > chunkSize / 4 && current != nullptr) {
+            chunks.push_back(allocateChunk(bytes + alignment));
+            char* data = chunks.back().data;
+            used += bytes;
+            return data + (-reinterpret_cast<uintptr_t>(data) & (alignment - 1));
+        }
+
+        Chunk chunk = allocateChunk(std::max(chunkSize, bytes + alignment));
+        chunks.push_back(chunk);
+        current = chunk.data;
+        end = chunk.data + chunk.size;
+        padding = -reinterpret_cast<uintptr_t>(current) & (alignment - 1);
+    }
+
+    char* data = current + padding;
+    current = data + bytes;
+    used += bytes;
+
+    return data;
+}
+
+void Arena::do_deallocate(void* pointer, size_t bytes, size_t alignment) {}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void Arena::release() {
+    for (const Chunk& chunk : chunks) {
+        deallocateChunk(chunk);
+    }
+    chunks.clear();
+    current = nullptr;
+    end = nullptr;
+    used = 0;
+}
+
+size_t Arena::getUsedSize() const {
+    return used;
+}
+
+size_t Arena::getReservedSize() const {
+    size_t size = 0;
+    for (const Chunk& chunk : chunks) {
+        size += chunk.size;
+    }
+    return size;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include <json/binary.h>
+#include <stdexcept>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+
+namespace JSON {
+
+BinaryPrinter::BinaryPrinter(std::ostream& output, Format format) : output(output), format(format) {
+    if (format == Format::TEXT) {
+        throw std::invalid_argument("JSON text is printed by JSON::Printer");
+    }
+}
+
+void BinaryPrinter::write(const char* data, size_t size) {
+    if (buffered > 0) {
+        buffer.append(data, size);
+    } else {
+        output.write(data, size);
+    }
+}
+
+void BinaryPrinter::writeByte(unsigned char byte) {
+    write((const char*)&byte, 1);
+}
+
+// writes a type byte followed by the last bytes of the value in big-endian order
+void BinaryPrinter::writeBigEndian(unsigned char type, uint64_t value, size_t size) {
+    char bytes[9];
+    bytes[0] = (char)type;
+    for (size_t i = size; i > 0; i--) {
+        bytes[i] = (char)(value & 0xFF);
+        value >>= 8;
+    }
+    write(bytes, size + 1);
+}
+
+// the head of a CBOR item holds its major type and an argument, which is its value or its size
+void BinaryPrinter::writeHead(int major, uint64_t argument) {
+    unsigned char type = (unsigned char)(major << 5);
+    if (argument < 24) {
+        writeByte(type | (unsigned char)argument);
+    } else if (argument <= UINT8_MAX) {
+        writeBigEndian(type | 24, argument, 1);
+    } else if (argument <= UINT16_MAX) {
+        writeBigEndian(type | 25, argument, 2);
+    } else if (argument <= UINT32_MAX) {
+        writeBigEndian(type | 26, argument, 4);
+    } else {
+        writeBigEndian(type | 27, argument, 8);
+    }
+}
+
+void BinaryPrinter::writeString(const char* str, size_t size) {
+    if (format == Format::CBOR) {
+        writeHead(3, size);
+    } else if (size < 32) {
+        writeByte(0xA0 | (unsigned char)size);
+    } else if (size <= UINT8_MAX) {
+        writeBigEndian(0xD9, size, 1);
+    } else if (size <= UINT16_MAX) {
+        writeBigEndian(0xDA, size, 2);
+    } else if (size <= UINT32_MAX) {
+        writeBigEndian(0xDB, size, 4);
+    } else {
+        throw std::length_error("string is too long for MessagePack");
+    }
+    write(str, size);
+}
+
+void BinaryPrinter::writeUnsigned(uint64_t value) {
+    if (format == Format::CBOR) {
+        writeHead(0, value);
+    } else if (value <= INT8_MAX) {
+        writeByte((unsigned char)value);
+    } else if (value <= UINT8_MAX) {
+        writeBigEndian(0xCC, value, 1);
+    } else if (value <= UINT16_MAX) {
+        writeBigEndian(0xCD, value, 2);
+    } else if (value <= UINT32_MAX) {
+        writeBigEndian(0xCE, value, 4);
+    } else {
+        writeBigEndian(0xCF, value, 8);
+    }
+}
+
+void BinaryPrinter::writeContainerHead(bool object, size_t size) {
+    if (format == Format::CBOR) {
+        writeHead(object ? 5 : 4, size);
+    } else if (size < 16) {
+        writeByte((object ? 0x80 : 0x90) | (unsigned char)size);
+    } else if (size <= UINT16_MAX) {
+        writeBigEndian(object ? 0xDE : 0xDC, size, 2);
+    } else if (size <= UINT32_MAX) {
+        writeBigEndian(object ? 0xDF : 0xDD, size, 4);
+    } else {
+        throw std::length_error("container is too large for MessagePack");
+    }
+}
+
+void BinaryPrinter::countItem(bool key) {
+    // the members of an object are counted by their keys
+    if (!containers.empty() && containers.back().object == key) {
+        containers.back().count++;
+    }
+}
+
+void BinaryPrinter::startContainer(bool object, size_t size) {
+
+    countItem(false);
+
+    if (size != unknownSize) {
+        writeContainerHead(object, size);
+        containers.push_back({ object, size, 0, unknownSize });
+    } else if (format == Format::CBOR) {
+        writeByte(object ? 0xBF : 0x9F);
+        containers.push_back({ object, size, 0, unknownSize });
+    } else {
+        // the header is written when the size is known, the content is buffered until then
+        if (buffered == 0) {
+            buffered = containers.size() + 1;
+        }
+        headers.push_back({ buffer.size(), object, 0 });
+        containers.push_back({ object, size, 0, headers.size() - 1 });
+    }
+}
+
+void BinaryPrinter::endContainer() {
+
+    Container container = containers.back();
+    containers.pop_back();
+
+    if (container.size != unknownSize) {
+        return;
+    }
+
+    if (format == Format::CBOR) {
+        writeByte(0xFF);
+        return;
+    }
+
+    headers[container.header].size = container.count;
+    if (containers.size() + 1 == buffered) {
+        flush();
+    }
+}
+
+// writes the buffered content with the headers of its containers, which all have their size
+void BinaryPrinter::flush() {
+    buffered = 0;
+    size_t position = 0;
+    for (const Header& header : headers) {
+        output.write(buffer.data() + position, header.position - position);
+        writeContainerHead(header.object, header.size);
+        position = header.position;
+    }
+    output.write(buffer.data() + position, buffer.size() - position);
+    buffer.clear();
+    headers.clear();
+}
+
+void BinaryPrinter::startObject(size_t size) {
+    startContainer(true, size);
+}
+
+void BinaryPrinter::endObject() {
+    endContainer();
+}
+
+void BinaryPrinter::startArray(size_t size) {
+    startContainer(false, size);
+}
+
+void BinaryPrinter::endArray() {
+    endContainer();
+}
+
+void BinaryPrinter::key(const char* key) {
+    countItem(true);
+    writeString(key, strlen(key));
+}
+
+void BinaryPrinter::key(const std::string& key) {
+    countItem(true);
+    writeString(key.data(), key.size());
+}
+
+void BinaryPrinter::value(const char* value) {
+    countItem(false);
+    writeString(value, strlen(value));
+}
+
+void BinaryPrinter::value(const std::string& value) {
+    countItem(false);
+    writeString(value.data(), value.size());
+}
+
+void BinaryPrinter::value(double value) {
+
+    countItem(false);
+
+    // a double is written as a float if the conversion is exact
+    if (!std::isfinite(value) || (std::fabs(value) <= FLT_MAX && (float)value == value)) {
+        float single = (float)value;
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        writeBigEndian(format == Format::CBOR ? 0xFA : 0xCA, bits, 4);
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        writeBigEndian(format == Format::CBOR ? 0xFB : 0xCB, bits, 8);
+    }
+}
+
+void BinaryPrinter::value(int64_t value) {
+
+    countItem(false);
+
+    if (value >= 0) {
+        writeUnsigned(value);
+    } else if (format == Format::CBOR) {
+        writeHead(1, ~(uint64_t)value);
+    } else if (value >= -32) {
+        writeByte((unsigned char)value);
+    } else if (value >= INT8_MIN) {
+        writeBigEndian(0xD0, value, 1);
+    } else if (value >= INT16_MIN) {
+        writeBigEndian(0xD1, value, 2);
+    } else if (value >= INT32_MIN) {
+        writeBigEndian(0xD2, value, 4);
+    } else {
+        writeBigEndian(0xD3, value, 8);
+    }
+}
+
+void BinaryPrinter::value(uint64_t value) {
+    countItem(false);
+    writeUnsigned(value);
+}
+
+void BinaryPrinter::value(bool value) {
+    countItem(false);
+    if (format == Format::CBOR) {
+        writeByte(value ? 0xF5 : 0xF4);
+    } else {
+        writeByte(value ? 0xC3 : 0xC2);
+    }
+}
+
+void BinaryPrinter::value() {
+    countItem(false);
+    writeByte(format == Format::CBOR ? 0xF6 : 0xC0);
+}
+
+void BinaryPrinter::startString() {
+    countItem(false);
+    if (format == Format::CBOR) {
+        writeByte(0x7F);
+    } else {
+        chunks.clear();
+    }
+}
+
+void BinaryPrinter::stringChunk(const char* chunk) {
+    if (format == Format::CBOR) {
+        writeString(chunk, strlen(chunk));
+    } else {
+        chunks.append(chunk);
+    }
+}
+
+void BinaryPrinter::stringChunk(const std::string& chunk) {
+    if (format == Format::CBOR) {
+        writeString(chunk.data(), chunk.size());
+    } else {
+        chunks.append(chunk);
+    }
+}
+
+void BinaryPrinter::endString() {
+    if (format == Format::CBOR) {
+        writeByte(0xFF);
+    } else {
+        writeString(chunks.data(), chunks.size());
+    }
+}
+
+}
\ No newline at end of file
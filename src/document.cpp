@@ -0,0 +1,718 @@
+#include <json/document.h>
+#include <json/parser.h>
+#include <algorithm>
+#include <system_error>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace JSON {
+
+/**
+ * Builds the tape of a document, from an input or from a value.
+ * The start of each open object or array is kept with the number of values read in it,
+ * they are written in its start and end words when it is closed.
+ * The positions of the keys of the open objects are kept to index them.
+ */
+class DocumentParser : public Parser {
+
+    struct Container {
+        size_t start;
+        uint64_t size;
+        size_t firstKey;
+    };
+
+    Document& document;
+    std::vector<Container> stack;
+    std::vector<uint64_t> keys;
+
+    void onValue() {
+        if (!stack.empty()) {
+            stack.back().size++;
+        }
+    }
+
+    void onContainerStart(Document::Tag tag) {
+        onValue();
+        stack.push_back({ document.words.size(), 0, keys.size() });
+        document.append(tag);
+    }
+
+    void onContainerEnd(Document::Tag tag, Document::Tag startTag) {
+        Container container = stack.back();
+        stack.pop_back();
+        if (tag == Document::Tag::OBJECT_END && container.size >= Document::indexedSize) {
+            document.appendIndex(keys, container.firstKey);
+        }
+        keys.resize(container.firstKey);
+        document.append(tag, container.size);
+        document.words[container.start] = ((uint64_t)startTag << 56) | document.words.size();
+    }
+
+    void onKey(std::string_view key) {
+        keys.push_back(document.words.size());
+        document.appendString(key);
+    }
+
+    void onString(std::string_view value) {
+        onValue();
+        document.appendString(value);
+    }
+
+    void onObjectStart() override { onContainerStart(Document::Tag::OBJECT); }
+    void onObjectEnd() override { onContainerEnd(Document::Tag::OBJECT_END, Document::Tag::OBJECT); }
+    void onArrayStart() override { onContainerStart(Document::Tag::ARRAY); }
+    void onArrayEnd() override { onContainerEnd(Document::Tag::ARRAY_END, Document::Tag::ARRAY); }
+    void onKey(std::string& key) override { onKey(std::string_view(key)); }
+    void onIndex(size_t index) override {}
+
+    void onNumber(double value) override {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        onValue();
+        document.append(Document::Tag::DOUBLE);
+        document.words.push_back(bits);
+    }
+
+    void onInteger(int64_t value) override {
+        onValue();
+        document.append(Document::Tag::INT64);
+        document.words.push_back((uint64_t)value);
+    }
+
+    void onUnsigned(uint64_t value) override {
+        onValue();
+        document.append(Document::Tag::UINT64);
+        document.words.push_back(value);
+    }
+
+    void onBoolean(bool value) override {
+        onValue();
+        document.append(value ? Document::Tag::TRUE_ : Document::Tag::FALSE_);
+    }
+
+    void onString(std::string& value) override {
+        onString(std::string_view(value));
+    }
+
+    void onNull() override {
+        onValue();
+        document.append(Document::Tag::NULL_);
+    }
+
+public:
+
+    DocumentParser(Document& document) : document(document) {}
+
+    void build(const Value& value) {
+        switch (value.getType()) {
+            case Type::NUMBER:
+                switch (value.getNumberType()) {
+                    case NumberType::INT64: onInteger(value.getIntegerValue()); break;
+                    case NumberType::UINT64: onUnsigned(value.getUnsignedValue()); break;
+                    default: onNumber(value.getNumberValue()); break;
+                }
+                break;
+            case Type::BOOLEAN: onBoolean(value.getBooleanValue()); break;
+            case Type::NULL_: onNull(); break;
+            case Type::STRING: onString(std::string_view(value.getStringValue())); break;
+            case Type::OBJECT:
+                onObjectStart();
+                for (auto& member : value.getObjectValue()) {
+                    onKey(member.first.view());
+                    build(member.second);
+                }
+                onObjectEnd();
+                break;
+            case Type::ARRAY:
+                onArrayStart();
+                // the elements of a packed array are read from its spans (see Value::pack)
+                if (value.isPacked(Type::BOOLEAN)) {
+                    for (Boolean element : value.getBooleanSpan()) {
+                        onBoolean(element);
+                    }
+                } else if (value.isPacked(Type::NUMBER, NumberType::INT64)) {
+                    for (Integer element : value.getIntegerSpan()) {
+                        onInteger(element);
+                    }
+                } else if (value.isPacked()) {
+                    for (Number element : value.getNumberSpan()) {
+                        onNumber(element);
+                    }
+                } else {
+                    for (auto& element : value.getArrayValue()) {
+                        build(element);
+                    }
+                }
+                onArrayEnd();
+                break;
+            default: throw Value::UndefinedValueError();
+        }
+    }
+};
+
+/**
+ * The header of a snapshot, followed by the words of the tape and by the strings.
+ * The byte order mark is read as a different number by a build with a different byte order.
+ */
+struct SnapshotHeader {
+    char magic[8];
+    uint64_t byteOrder;
+    uint64_t wordCount;
+    uint64_t stringSize;
+};
+
+static const char snapshotMagic[8] = { 'J', 'S', 'O', 'N', 'T', 'A', 'P', '1' };
+static const uint64_t snapshotByteOrder = 0x0102030405060708;
+
+Document::SnapshotError::SnapshotError(const std::string& reason) {
+    message = "invalid JSON snapshot: " + reason;
+}
+
+Document::Document(std::istream& input) {
+    parse(input);
+}
+
+Document::Document(const Value& value) {
+    assign(value);
+}
+
+Document::Document(const Document& document) :
+    words(document.words), strings(document.strings), mapping(document.mapping) {
+    attach(document);
+}
+
+Document::Document(Document&& document) noexcept :
+    words(std::move(document.words)), strings(std::move(document.strings)), mapping(std::move(document.mapping)) {
+    attach(document);
+    document.clear();
+}
+
+Document& Document::operator=(const Document& document) {
+    if (this != &document) {
+        words = document.words;
+        strings = document.strings;
+        mapping = document.mapping;
+        attach(document);
+    }
+    return *this;
+}
+
+Document& Document::operator=(Document&& document) noexcept {
+    if (this != &document) {
+        words = std::move(document.words);
+        strings = std::move(document.strings);
+        mapping = std::move(document.mapping);
+        attach(document);
+        document.clear();
+    }
+    return *this;
+}
+
+// reads the tape of the given document if it is mapped, which is shared, otherwise the vectors of this one
+void Document::attach(const Document& document) {
+    if (mapping != nullptr) {
+        wordData = document.wordData;
+        wordCount = document.wordCount;
+        stringData = document.stringData;
+        stringSize = document.stringSize;
+    } else {
+        attach();
+    }
+}
+
+void Document::attach() {
+    wordData = words.data();
+    wordCount = words.size();
+    stringData = strings.data();
+    stringSize = strings.size();
+}
+
+void Document::parse(std::istream& input) {
+    Status status = tryParse(input);
+    if (!status.ok()) {
+        Parser::throwError(status);
+    }
+}
+
+Status Document::tryParse(std::istream& input) {
+    clear();
+    Status status = DocumentParser(*this).tryParse(input);
+    if (!status.ok()) {
+        clear();
+    }
+    attach();
+    return status;
+}
+
+void Document::parse(const Tape& tape) {
+    clear();
+    Status status = DocumentParser(*this).tryParse(tape);
+    if (!status.ok()) {
+        clear();
+        Parser::throwError(status);
+    }
+    attach();
+}
+
+void Document::assign(const Value& value) {
+    clear();
+    try {
+        DocumentParser(*this).build(value);
+    } catch (...) {
+        clear();
+        throw;
+    }
+    attach();
+}
+
+void Document::save(std::ostream& output) const {
+    SnapshotHeader header;
+    memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+    header.byteOrder = snapshotByteOrder;
+    header.wordCount = wordCount;
+    header.stringSize = stringSize;
+    output.write((const char*)&header, sizeof(header));
+    output.write((const char*)wordData, wordCount * sizeof(uint64_t));
+    output.write(stringData, stringSize);
+}
+
+void Document::map(const std::string& path) {
+
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot open JSON snapshot");
+    }
+
+    struct stat info;
+    if (fstat(file, &info) < 0) {
+        int error = errno;
+        close(file);
+        throw std::system_error(error, std::generic_category(), "cannot open JSON snapshot");
+    }
+
+    size_t size = info.st_size;
+    if (size < sizeof(SnapshotHeader)) {
+        close(file);
+        throw SnapshotError("file is too small");
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    int error = errno;
+    close(file);
+    if (data == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), "cannot map JSON snapshot");
+    }
+
+    std::shared_ptr<const void> snapshot(data, [size](const void* data) { munmap(const_cast<void*>(data), size); });
+
+    // the pages are aligned, so the words that follow the header are aligned too
+    const SnapshotHeader* header = static_cast<const SnapshotHeader*>(data);
+    if (memcmp(header->magic, snapshotMagic, sizeof(header->magic)) != 0) {
+        throw SnapshotError("wrong magic number");
+    }
+    if (header->byteOrder != snapshotByteOrder) {
+        throw SnapshotError("wrong byte order");
+    }
+    if (header->wordCount > (size - sizeof(SnapshotHeader)) / sizeof(uint64_t) ||
+        header->stringSize != size - sizeof(SnapshotHeader) - header->wordCount * sizeof(uint64_t)) {
+        throw SnapshotError("wrong size");
+    }
+
+    words.clear();
+    strings.clear();
+    mapping = std::move(snapshot);
+    wordData = reinterpret_cast<const uint64_t*>(header + 1);
+    wordCount = header->wordCount;
+    stringData = reinterpret_cast<const char*>(wordData + wordCount);
+    stringSize = header->stringSize;
+}
+
+void Document::clear() {
+    words.clear();
+    strings.clear();
+    mapping.reset();
+    attach();
+}
+
+Element Document::getRoot() const {
+    return wordCount == 0 ? Element() : Element(this, 0);
+}
+
+size_t Document::getUsedSize() const {
+    return wordCount * sizeof(uint64_t) + stringSize;
+}
+
+void Document::append(Tag tag, uint64_t payload) {
+    words.push_back(((uint64_t)tag << 56) | payload);
+}
+
+// a string is its offset in the buffer followed by its size, it is also terminated by a null character for printing
+void Document::appendString(std::string_view value) {
+    append(Tag::STRING, strings.size());
+    words.push_back(value.size());
+    strings.append(value.data(), value.size());
+    strings.push_back('\0');
+}
+
+// the index is the positions of the keys sorted by key, equal keys stay in the order of the object
+void Document::appendIndex(std::vector<uint64_t>& keys, size_t first) {
+    auto key = [this](uint64_t index) {
+        return std::string_view(strings.data() + (words[index] & 0xFFFFFFFFFFFFFF), words[index + 1]);
+    };
+    std::stable_sort(keys.begin() + first, keys.end(), [&](uint64_t a, uint64_t b) { return key(a) < key(b); });
+    words.insert(words.end(), keys.begin() + first, keys.end());
+}
+
+Document::Tag Document::getTag(size_t index) const {
+    return (Tag)(wordData[index] >> 56);
+}
+
+uint64_t Document::getPayload(size_t index) const {
+    return wordData[index] & 0xFFFFFFFFFFFFFF;
+}
+
+std::string_view Document::getString(size_t index) const {
+    return std::string_view(stringData + getPayload(index), wordData[index + 1]);
+}
+
+const char* Document::getCString(size_t index) const {
+    return stringData + getPayload(index);
+}
+
+size_t Document::next(size_t index) const {
+    switch (getTag(index)) {
+        case Tag::OBJECT:
+        case Tag::ARRAY:
+            return getPayload(index);
+        case Tag::STRING:
+        case Tag::DOUBLE:
+        case Tag::INT64:
+        case Tag::UINT64:
+            return index + 2;
+        default:
+            return index + 1;
+    }
+}
+
+Element::Element(const Document* document, size_t index) : document(document), index(index) {}
+
+Element::Iterator::Iterator(const Document* document, size_t index, bool object) :
+    document(document), index(index), object(object) {}
+
+Element Element::Iterator::operator*() const {
+    // the value of a member follows its key
+    return Element(document, object ? index + 2 : index);
+}
+
+Element::Iterator& Element::Iterator::operator++() {
+    index = document->next(object ? index + 2 : index);
+    return *this;
+}
+
+bool Element::Iterator::operator==(const Iterator& iterator) const {
+    return index == iterator.index && document == iterator.document;
+}
+
+bool Element::Iterator::operator!=(const Iterator& iterator) const {
+    return !(*this == iterator);
+}
+
+std::string_view Element::Iterator::getKey() const {
+    return document->getString(index);
+}
+
+Type Element::getType() const {
+    if (document == nullptr) {
+        return Type::UNDEFINED;
+    }
+    switch (document->getTag(index)) {
+        case Document::Tag::OBJECT: return Type::OBJECT;
+        case Document::Tag::ARRAY: return Type::ARRAY;
+        case Document::Tag::STRING: return Type::STRING;
+        case Document::Tag::DOUBLE:
+        case Document::Tag::INT64:
+        case Document::Tag::UINT64: return Type::NUMBER;
+        case Document::Tag::TRUE_:
+        case Document::Tag::FALSE_: return Type::BOOLEAN;
+        case Document::Tag::NULL_: return Type::NULL_;
+        default: return Type::UNDEFINED;
+    }
+}
+
+bool Element::hasType(Type type) const { return getType() == type; }
+bool Element::isUndefined() const { return document == nullptr; }
+void Element::assertType(Type type) const { if (getType() != type) throw Value::TypeAssertionError(type); }
+
+// the number is read as a value so that the conversions are the same
+Value Element::getNumber() const {
+    assertType(Type::NUMBER);
+    uint64_t bits = document->wordData[index + 1];
+    switch (document->getTag(index)) {
+        case Document::Tag::INT64: return (Integer)bits;
+        case Document::Tag::UINT64: return (Unsigned)bits;
+        default: {
+            Number number;
+            memcpy(&number, &bits, sizeof(number));
+            return number;
+        }
+    }
+}
+
+NumberType Element::getNumberType() const { return getNumber().getNumberType(); }
+Number Element::getNumberValue() const {
+    assertType(Type::NUMBER);
+    uint64_t bits = document->wordData[index + 1];
+    switch (document->getTag(index)) {
+        case Document::Tag::INT64: return (Integer)bits;
+        case Document::Tag::UINT64: return bits;
+        default: {
+            Number number;
+            memcpy(&number, &bits, sizeof(number));
+            return number;
+        }
+    }
+}
+Integer Element::getIntegerValue() const { return getNumber().getIntegerValue(); }
+Unsigned Element::getUnsignedValue() const { return getNumber().getUnsignedValue(); }
+Boolean Element::getBooleanValue() const { assertType(Type::BOOLEAN); return document->getTag(index) == Document::Tag::TRUE_; }
+Null Element::getNullValue() const { assertType(Type::NULL_); return null; }
+std::string_view Element::getStringValue() const { assertType(Type::STRING); return document->getString(index); }
+
+size_t Element::getSize() const {
+    if (!hasType(Type::OBJECT)) {
+        assertType(Type::ARRAY);
+    }
+    return document->getPayload(document->getPayload(index) - 1);
+}
+
+Element::Iterator Element::begin() const {
+    if (!hasType(Type::OBJECT)) {
+        assertType(Type::ARRAY);
+    }
+    return Iterator(document, index + 1, hasType(Type::OBJECT));
+}
+
+Element::Iterator Element::end() const {
+    if (!hasType(Type::OBJECT)) {
+        assertType(Type::ARRAY);
+    }
+    // the members of an indexed object end where its index starts
+    size_t last = document->getPayload(index) - 1;
+    if (hasType(Type::OBJECT) && document->getPayload(last) >= Document::indexedSize) {
+        last -= document->getPayload(last);
+    }
+    return Iterator(document, last, hasType(Type::OBJECT));
+}
+
+// returns the last member with the given key, or an undefined element
+Element Element::findMember(std::string_view key) const {
+
+    size_t last = document->getPayload(index) - 1;
+    size_t size = document->getPayload(last);
+    Element element;
+
+    if (size < Document::indexedSize) {
+        for (Iterator it = begin(), end = this->end(); it != end; ++it) {
+            if (it.getKey() == key) {
+                element = *it;
+            }
+        }
+        return element;
+    }
+
+    const uint64_t* keys = document->wordData + last - size;
+    const uint64_t* found = std::upper_bound(keys, keys + size, key, [this](std::string_view key, uint64_t position) {
+        return key < document->getString(position);
+    });
+    if (found != keys && document->getString(found[-1]) == key) {
+        element = Element(document, found[-1] + 2);
+    }
+    return element;
+}
+
+Element Element::operator[](std::string_view key) const {
+    assertType(Type::OBJECT);
+    Element element = findMember(key);
+    if (element.isUndefined()) {
+        throw Value::KeyError(std::string(key));
+    }
+    return element;
+}
+
+Element Element::operator[](size_t index) const {
+    assertType(Type::ARRAY);
+    size_t i = 0;
+    for (Iterator it = begin(), last = end(); it != last; ++it, i++) {
+        if (i == index) {
+            return *it;
+        }
+    }
+    throw Value::KeyError(std::to_string(index));
+}
+
+bool Element::findFirst(Path::Cursor& cursor, Element& result) const {
+
+    if (cursor.isInTarget()) {
+        result = *this;
+        return true;
+    }
+
+    if (cursor.isInPath()) {
+
+        switch (getType()) {
+
+            case Type::ARRAY: {
+                size_t index = 0;
+                for (Iterator it = begin(), last = end(); it != last; ++it, index++) {
+                    cursor.next(index);
+                    if ((*it).findFirst(cursor, result)) {
+                        return true;
+                    }
+                    cursor.prev();
+                }
+                break;
+            }
+
+            case Type::OBJECT: {
+                std::string key;
+                for (Iterator it = begin(), last = end(); it != last; ++it) {
+                    key.assign(it.getKey());
+                    cursor.next(key);
+                    if ((*it).findFirst(cursor, result)) {
+                        return true;
+                    }
+                    cursor.prev();
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    return false;
+}
+
+void Element::findAll(std::vector<Element>& all, Path::Cursor& cursor) const {
+
+    if (cursor.isInTarget()) {
+        return all.push_back(*this);
+    }
+
+    if (cursor.isInPath()) {
+
+        switch (getType()) {
+
+            case Type::ARRAY: {
+                size_t index = 0;
+                for (Iterator it = begin(), last = end(); it != last; ++it, index++) {
+                    cursor.next(index);
+                    (*it).findAll(all, cursor);
+                    cursor.prev();
+                }
+                break;
+            }
+
+            case Type::OBJECT: {
+                std::string key;
+                for (Iterator it = begin(), last = end(); it != last; ++it) {
+                    key.assign(it.getKey());
+                    cursor.next(key);
+                    (*it).findAll(all, cursor);
+                    cursor.prev();
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+}
+
+Element Element::findFirst(const Path& path) const {
+    Path::Cursor cursor(path);
+    Element result;
+    findFirst(cursor, result);
+    return result;
+}
+
+std::vector<Element> Element::findAll(const Path& path) const {
+    Path::Cursor cursor(path);
+    std::vector<Element> all;
+    findAll(all, cursor);
+    return all;
+}
+
+void Element::print(Printer& printer) const {
+    switch (getType()) {
+        case Type::NUMBER:
+            switch (document->getTag(index)) {
+                case Document::Tag::INT64: printer.value((int64_t)document->wordData[index + 1]); break;
+                case Document::Tag::UINT64: printer.value((uint64_t)document->wordData[index + 1]); break;
+                default: printer.value(getNumberValue()); break;
+            }
+            break;
+        case Type::BOOLEAN: printer.value(getBooleanValue()); break;
+        case Type::NULL_: printer.value(); break;
+        case Type::STRING: printer.value(document->getCString(index)); break;
+        case Type::OBJECT:
+            printer.startObject();
+            for (Iterator it = begin(), last = end(); it != last; ++it) {
+                printer.key(document->getCString(it.index));
+                (*it).print(printer);
+            }
+            printer.endObject();
+            break;
+        case Type::ARRAY:
+            printer.startArray();
+            for (Iterator it = begin(), last = end(); it != last; ++it) {
+                (*it).print(printer);
+            }
+            printer.endArray();
+            break;
+        default: throw Value::UndefinedValueError();
+    }
+}
+
+void Element::print(std::ostream& output, int indent, bool escapeUnicode, bool color) const {
+    Printer printer(output, indent, escapeUnicode, color);
+    print(printer);
+}
+
+Value Element::toValue() const {
+    switch (getType()) {
+        case Type::NUMBER: return getNumber();
+        case Type::BOOLEAN: return getBooleanValue();
+        case Type::NULL_: return null;
+        case Type::STRING: return String(getStringValue());
+        case Type::OBJECT: {
+            Object object;
+            for (Iterator it = begin(), last = end(); it != last; ++it) {
+                object[String(it.getKey())] = (*it).toValue();
+            }
+            return object;
+        }
+        case Type::ARRAY: {
+            Array array;
+            array.reserve(getSize());
+            for (Iterator it = begin(), last = end(); it != last; ++it) {
+                array.push_back((*it).toValue());
+            }
+            return array;
+        }
+        default: return Value();
+    }
+}
+
+}
+
+std::ostream& operator<<(std::ostream& output, const JSON::Element& element) {
+    element.print(output);
+    return output;
+}
\ No newline at end of file
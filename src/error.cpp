@@ -1,4 +1,7 @@
 #include <json/error.h>
+#include <json/lexer.h>
+#include <sstream>
+#include <cctype>
 
 namespace JSON {
 
@@ -6,8 +9,40 @@ const char* Error::what() const noexcept {
     return message.c_str();
 }
 
+bool Status::ok() const {
+    return code == OK;
+}
+
+Status::operator bool() const {
+    return code == OK;
+}
+
+std::string Status::message() const {
+
+    std::ostringstream s;
+
+    switch (code) {
+        case OK: return "no error";
+        case INVALID_CHARACTER: s << "invalid character "; if (isprint(c)) s << "'" << c << "'"; else s << (int)c; break;
+        case INVALID_NUMBER: s << "invalid number"; break;
+        case UNTERMINATED_STRING: s << "unterminated string"; break;
+        case INVALID_ESCAPE_SEQUENCE: s << "invalid escape sequence '\\" << c << "'"; break;
+        case INVALID_UNICODE_ESCAPE_SEQUENCE: s << "invalid unicode escape sequence"; break;
+        case UNEXPECTED_TOKEN: s << "unexpected token " << token; break;
+        default: s << "unknown error"; break;
+    }
+
+    s << " at line " << lineNumber << " (char " << charPos << ")";
+
+    return s.str();
+}
+
 }
 
 std::ostream& operator<<(std::ostream& stream, const JSON::Error& error) {
     return stream << error.what();
+}
+
+std::ostream& operator<<(std::ostream& stream, const JSON::Status& status) {
+    return stream << status.message();
 }
\ No newline at end of file
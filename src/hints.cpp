@@ -0,0 +1,51 @@
+#include <json/hints.h>
+
+namespace JSON {
+
+static thread_local SizeHints* currentHints = nullptr;
+
+SizeHints::Node::Node(SizeHints* hints) : hints(hints) {}
+
+SizeHints::Node* SizeHints::Node::getMember(const std::string& key) {
+    auto it = members.find(key);
+    if (it != members.end()) {
+        return it->second.get();
+    }
+    if (members.size() >= hints->maxKeys) {
+        return nullptr;
+    }
+    hints->count++;
+    return members.emplace(key, std::unique_ptr<Node>(new Node(hints))).first->second.get();
+}
+
+SizeHints::Node* SizeHints::Node::getElements() {
+    if (elements == nullptr) {
+        hints->count++;
+        elements.reset(new Node(hints));
+    }
+    return elements.get();
+}
+
+SizeHints::Scope::Scope(SizeHints& hints) : previous(currentHints) {
+    currentHints = &hints;
+}
+
+SizeHints::Scope::~Scope() {
+    currentHints = previous;
+}
+
+SizeHints::SizeHints(size_t maxKeys) : maxKeys(maxKeys), root(this) {}
+
+SizeHints::Node* SizeHints::getRoot() {
+    return &root;
+}
+
+size_t SizeHints::getCount() const {
+    return count;
+}
+
+SizeHints* SizeHints::getCurrent() {
+    return currentHints;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include <json/incremental.h>
+#include <json/parser.h>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace JSON {
+
+/**
+ * Builds a value like Value::parse and records the span of every value.
+ * The spans of the children are relative to their parent, the span of the root is absolute.
+ */
+class SpanParser : public Parser {
+
+    struct Frame {
+        Value* value;
+        IncrementalParser::Span* span;
+        size_t begin;
+        std::vector<std::string> keys;
+    };
+
+    Value& root;
+    IncrementalParser::Span& rootSpan;
+    size_t base;
+    std::vector<Frame> stack;
+    std::string key;
+
+    Frame add(Value&& value, size_t begin) {
+
+        if (stack.empty()) {
+            root = std::move(value);
+            rootSpan = { begin, 0, &root, {} };
+            return { &root, &rootSpan, begin, {} };
+        }
+
+        Frame& parent = stack.back();
+        Value* child;
+
+        if (parent.value->hasType(Type::ARRAY)) {
+            Array& array = parent.value->getArrayValue();
+            array.push_back(std::move(value));
+            child = &array.back();
+        }
+        else {
+            Object& object = parent.value->getObjectValue();
+            parent.keys.push_back(key);
+            auto it = object.find(key);
+            if (it == object.end()) {
+                child = &object.emplace(std::move(key), std::move(value)).first->second;
+            } else {
+                it->second = std::move(value);
+                child = &it->second;
+            }
+        }
+
+        parent.span->children.push_back({ begin - parent.begin, 0, child, {} });
+
+        return { child, &parent.span->children.back(), begin, {} };
+    }
+
+    void addPrimitive(Value&& value) {
+        size_t begin = base + getLexer().getTokenOffset();
+        Frame frame = add(std::move(value), begin);
+        frame.span->length = base + getLexer().getOffset() - begin;
+    }
+
+    void start(Value&& value) {
+        stack.push_back(add(std::move(value), base + getLexer().getTokenOffset()));
+    }
+
+    void end() {
+        Frame& frame = stack.back();
+        frame.span->length = base + getLexer().getPreviousTokenEnd() - frame.begin;
+        std::vector<IncrementalParser::Span>& children = frame.span->children;
+        // the elements may have been moved while the array or the object was growing
+        if (frame.value->hasType(Type::ARRAY)) {
+            Array& array = frame.value->getArrayValue();
+            for (size_t index = 0; index < array.size(); index++) {
+                children[index].value = &array[index];
+            }
+        } else if (frame.value->hasType(Type::OBJECT)) {
+            Object& object = frame.value->getObjectValue();
+            // with duplicate keys, only the last span of a key keeps the value
+            bool duplicates = object.size() != children.size();
+            for (size_t index = children.size(); index-- > 0;) {
+                Value* value = &object.find(frame.keys[index])->second;
+                for (size_t next = index + 1; duplicates && next < children.size(); next++) {
+                    if (children[next].value == value) {
+                        value = nullptr;
+                        break;
+                    }
+                }
+                children[index].value = value;
+            }
+        }
+        stack.pop_back();
+    }
+
+    void onObjectStart() override { start(Object()); }
+    void onObjectEnd() override { end(); }
+    void onArrayStart() override { start(Array()); }
+    void onArrayEnd() override { end(); }
+    void onKey(std::string& key) override { this->key = std::move(key); }
+    void onIndex(size_t index) override {}
+    void onNumber(double value) override { addPrimitive(value); }
+    void onInteger(int64_t value) override { addPrimitive(value); }
+    void onUnsigned(uint64_t value) override { addPrimitive(value); }
+    void onBoolean(bool value) override { addPrimitive(value); }
+    void onString(std::string& value) override { addPrimitive(std::move(value)); }
+    void onNull() override { addPrimitive(null); }
+
+public:
+
+    SpanParser(Value& root, IncrementalParser::Span& rootSpan, size_t base) :
+        root(root), rootSpan(rootSpan), base(base) {}
+};
+
+IncrementalParser::IncrementalParser() :
+    root{ 0, 0, nullptr, {} }, valid(false) {}
+
+Status IncrementalParser::parseRegion(Value& target, Span& span, size_t begin, size_t end) {
+
+    std::istringstream input(text.substr(begin, end - begin));
+    SpanParser parser(target, span, begin);
+    Status status = parser.tryParse(input);
+
+    const Lexer& lexer = parser.getLexer();
+    if (status.ok() && lexer.getToken() != Token::END_OF_STREAM) {
+        status.code = Status::UNEXPECTED_TOKEN;
+        status.token = lexer.getToken();
+        status.offset = begin + lexer.getTokenOffset();
+        status.lineNumber = lexer.getTokenLineNumber();
+        status.charPos = lexer.getTokenCharPos();
+    }
+
+    return status;
+}
+
+Status IncrementalParser::parseAll() {
+    Span span{ 0, 0, nullptr, {} };
+    value.clear();
+    Status status = parseRegion(value, span, 0, text.size());
+    valid = status.ok();
+    root = valid ? std::move(span) : Span{ 0, 0, nullptr, {} };
+    return status;
+}
+
+void IncrementalParser::parse(std::string text) {
+    Status status = tryParse(std::move(text));
+    if (!status.ok()) {
+        Parser::throwError(status);
+    }
+}
+
+Status IncrementalParser::tryParse(std::string text) {
+    this->text = std::move(text);
+    return parseAll();
+}
+
+void IncrementalParser::edit(size_t offset, size_t removed, const std::string& inserted) {
+    Status status = tryEdit(offset, removed, inserted);
+    if (!status.ok()) {
+        Parser::throwError(status);
+    }
+}
+
+Status IncrementalParser::tryEdit(size_t offset, size_t removed, const std::string& inserted) {
+
+    if (offset > text.size() || removed > text.size() - offset) {
+        throw std::out_of_range("edit is out of the text");
+    }
+
+    text.replace(offset, removed, inserted);
+
+    if (!valid) {
+        return parseAll();
+    }
+
+    struct Step {
+        Span* span;
+        size_t begin;
+        size_t index;
+    };
+
+    // find the deepest spans that enclose the edit, without touching the delimiters of objects and arrays
+    std::vector<Step> path { { &root, root.begin, 0 } };
+    size_t end = offset + removed;
+
+    while (offset >= path.back().begin) {
+
+        std::vector<Span>& children = path.back().span->children;
+        size_t parentBegin = path.back().begin;
+
+        auto it = std::upper_bound(children.begin(), children.end(), offset - parentBegin,
+            [](size_t offset, const Span& span) { return offset < span.begin; });
+
+        if (it == children.begin() || (--it)->value == nullptr) {
+            break;
+        }
+
+        size_t begin = parentBegin + it->begin;
+        size_t spanEnd = begin + it->length;
+
+        bool enclosed = it->value->hasType(Type::OBJECT) || it->value->hasType(Type::ARRAY) ?
+            begin < offset && end < spanEnd :
+            begin <= offset && end <= spanEnd;
+
+        if (!enclosed) {
+            break;
+        }
+
+        path.push_back({ &*it, begin, (size_t)(it - children.begin()) });
+    }
+
+    // unsigned arithmetic, the shift can be negative
+    size_t delta = inserted.size() - removed;
+
+    for (size_t i = path.size() - 1; i > 0; i--) {
+
+        Step& step = path[i];
+        Span span{ 0, 0, nullptr, {} };
+
+        if (parseRegion(*step.span->value, span, step.begin, step.begin + step.span->length + delta).ok()) {
+
+            span.begin -= path[i - 1].begin;
+            *step.span = std::move(span);
+
+            for (size_t j = i; j > 0; j--) {
+                std::vector<Span>& siblings = path[j - 1].span->children;
+                for (size_t k = path[j].index + 1; k < siblings.size(); k++) {
+                    siblings[k].begin += delta;
+                }
+                path[j - 1].span->length += delta;
+            }
+
+            return Status();
+        }
+    }
+
+    return parseAll();
+}
+
+const std::string& IncrementalParser::getText() const {
+    return text;
+}
+
+const Value& IncrementalParser::getValue() const {
+    return value;
+}
+
+const IncrementalParser::Span& IncrementalParser::getSpan() const {
+    return root;
+}
+
+bool IncrementalParser::isValid() const {
+    return valid;
+}
+
+}
\ No newline at end of file
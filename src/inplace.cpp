@@ -0,0 +1,152 @@
+#include <json/inplace.h>
+#include <json/parser.h>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace JSON {
+
+/**
+ * Sets the values of the document in the existing value.
+ * The keys of the objects being parsed are kept in the slots of a vector which is never shrunk, so that
+ * their buffers are reused, and the members of an object whose keys were not parsed are erased at its end.
+ */
+class InPlaceParser::Handler : public Parser {
+
+    /**
+     * An object or array being parsed, with the number of elements parsed so far for an array,
+     * or the slot of the first key of an object.
+     */
+    struct Frame {
+        Array* array;
+        Object* object;
+        size_t count;
+    };
+
+    Value* root = nullptr;
+    std::vector<Frame> frames;
+    std::vector<std::string> keys;
+    size_t keyCount = 0;
+
+    /**
+     * Returns the value that the next value of the document overwrites : the root, the next element of the
+     * current array or the member of the current object with the last key, which are created if needed.
+     */
+    Value& getTarget() {
+        if (frames.empty()) {
+            return *root;
+        }
+        Frame& frame = frames.back();
+        if (frame.array != nullptr) {
+            Array& array = *frame.array;
+            if (frame.count < array.size()) {
+                return array[frame.count++];
+            }
+            frame.count++;
+            return array.emplace_back();
+        }
+        Object& object = *frame.object;
+        const std::string& key = keys[keyCount - 1];
+        auto it = object.find(key);
+        if (it != object.end()) {
+            return it->second;
+        }
+        return object.try_emplace(Key(key)).first->second;
+    }
+
+    // erases the members whose keys are not in the slots from the given one, unless all the members are found
+    void eraseMissing(Object& object, size_t first) {
+        auto begin = keys.begin() + first;
+        auto end = std::unique(begin, keys.begin() + keyCount);
+        if ((size_t)(end - begin) == object.size()) {
+            return;
+        }
+        auto less = [](std::string_view first, std::string_view second) { return first < second; };
+        for (auto it = object.begin(); it != object.end();) {
+            if (std::binary_search(begin, end, std::string_view(it->first), less)) {
+                ++it;
+            } else {
+                it = object.erase(it);
+            }
+        }
+    }
+
+    void onNumber(double value) override { getTarget() = value; }
+    void onInteger(int64_t value) override { getTarget() = value; }
+    void onUnsigned(uint64_t value) override { getTarget() = value; }
+    void onBoolean(bool value) override { getTarget() = value; }
+    void onNull() override { getTarget() = null; }
+    void onIndex(size_t index) override {}
+
+    void onString(std::string& value) override {
+        Value& target = getTarget();
+        if (target.hasType(Type::STRING)) {
+            target.getStringValue().assign(value);
+        } else {
+            target = std::move(value);
+        }
+    }
+
+    void onKey(std::string& key) override {
+        if (keyCount == keys.size()) {
+            keys.emplace_back();
+        }
+        keys[keyCount++].assign(key);
+    }
+
+    void onObjectStart() override {
+        Value& target = getTarget();
+        if (target.isLazy() || !target.hasType(Type::OBJECT)) {
+            target.setObjectValue();
+        }
+        frames.push_back({ nullptr, &target.getObjectValue(), keyCount });
+    }
+
+    void onObjectEnd() override {
+        Frame& frame = frames.back();
+        // the keys are sorted in their slots, the buffers are swapped so no memory is allocated
+        std::sort(keys.begin() + frame.count, keys.begin() + keyCount);
+        eraseMissing(*frame.object, frame.count);
+        keyCount = frame.count;
+        frames.pop_back();
+    }
+
+    void onArrayStart() override {
+        Value& target = getTarget();
+        if (target.isLazy() || !target.hasType(Type::ARRAY)) {
+            target.setArrayValue();
+        }
+        frames.push_back({ &target.getArrayValue(), nullptr, 0 });
+    }
+
+    void onArrayEnd() override {
+        Frame& frame = frames.back();
+        frame.array->erase(frame.array->begin() + frame.count, frame.array->end());
+        frames.pop_back();
+    }
+
+public:
+
+    void setRoot(Value& value) {
+        root = &value;
+        frames.clear();
+        keyCount = 0;
+    }
+};
+
+InPlaceParser::InPlaceParser() : handler(new Handler()) {}
+
+InPlaceParser::~InPlaceParser() = default;
+
+void InPlaceParser::parse(Value& value, std::istream& input) {
+    handler->setRoot(value);
+    handler->parse(input);
+}
+
+Status InPlaceParser::tryParse(Value& value, std::istream& input) {
+    handler->setRoot(value);
+    return handler->tryParse(input);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <json/input.h>
+#include <streambuf>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace JSON {
+
+/**
+ * A single-producer single-consumer ring of buffers.
+ * The reader thread fills the slots [tail, tail + slots.size()) and publishes them by incrementing head,
+ * the stream reads the slot at tail and releases it by incrementing tail.
+ * A slot of size 0 marks the end of the file (or a read error).
+ * When the ring is full the reader thread sleeps, and when it is empty the stream sleeps. Each side raises
+ * a waiting flag before sleeping, and the other side only takes the mutex to wake it if the flag is raised,
+ * so the buffers are still handed over without locks while neither side waits.
+ */
+class PipelinedInput::Buffer : public std::streambuf {
+
+    struct Slot {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    int fd;
+    bool owner;
+    size_t bufferSize;
+    std::vector<Slot> slots;
+
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    std::atomic<bool> stop{false};
+
+    std::mutex mutex;
+    std::condition_variable emptied;
+    std::condition_variable filled;
+    std::atomic<bool> readerWaiting{false};
+    std::atomic<bool> streamWaiting{false};
+
+    int error = 0;
+    int streamError = 0;
+    bool reading = false;
+    std::thread reader;
+
+    void read() {
+
+        off_t offset = 0;
+
+        for (size_t index = 0; ; index++) {
+
+            if (index - tail.load(std::memory_order_acquire) >= slots.size()) {
+                // the flag is raised before checking tail again, so that the stream sees it after releasing a slot
+                std::unique_lock<std::mutex> lock(mutex);
+                readerWaiting.store(true);
+                emptied.wait(lock, [&] { return stop.load() || index - tail.load() < slots.size(); });
+                readerWaiting.store(false);
+                if (stop.load()) {
+                    return;
+                }
+            }
+
+            Slot& slot = slots[index % slots.size()];
+
+            ssize_t size;
+            do {
+                size = pread(fd, slot.data.get(), bufferSize, offset);
+            } while (size < 0 && errno == EINTR);
+
+            if (size < 0) {
+                error = errno;
+                size = 0;
+            }
+
+            slot.size = size;
+            offset += size;
+
+            head.store(index + 1);
+            if (streamWaiting.load()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                filled.notify_one();
+            }
+
+            if (size == 0) {
+                return;
+            }
+        }
+    }
+
+protected:
+
+    int_type underflow() override {
+
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        size_t index = tail.load(std::memory_order_relaxed);
+
+        if (reading) {
+            reading = false;
+            tail.store(++index);
+            if (readerWaiting.load()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                emptied.notify_one();
+            }
+        }
+
+        if (head.load(std::memory_order_acquire) == index) {
+            std::unique_lock<std::mutex> lock(mutex);
+            streamWaiting.store(true);
+            filled.wait(lock, [&] { return head.load() != index; });
+            streamWaiting.store(false);
+        }
+
+        Slot& slot = slots[index % slots.size()];
+
+        // a read error ends the stream like the end of the file, exceptions would be swallowed by the istream,
+        // the error is copied in this thread since it is written by the reader thread before publishing the slot
+        if (slot.size == 0) {
+            streamError = error;
+            return traits_type::eof();
+        }
+
+        reading = true;
+        setg(slot.data.get(), slot.data.get(), slot.data.get() + slot.size);
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+public:
+
+    Buffer(int fd, bool owner, size_t bufferSize, size_t bufferCount) :
+        fd(fd), owner(owner), bufferSize(bufferSize > 0 ? bufferSize : 1), slots(bufferCount > 0 ? bufferCount : 1) {
+
+        for (Slot& slot : slots) {
+            slot.data.reset(new char[this->bufferSize]);
+        }
+
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            reader = std::thread(&Buffer::read, this);
+        }
+    }
+
+    ~Buffer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop.store(true);
+        }
+        emptied.notify_one();
+        if (reader.joinable()) {
+            reader.join();
+        }
+        if (owner && fd >= 0) {
+            close(fd);
+        }
+    }
+
+    bool isOpen() const {
+        return fd >= 0;
+    }
+
+    int getError() const {
+        return streamError;
+    }
+};
+
+PipelinedInput::PipelinedInput(const std::string& file, size_t bufferSize, size_t bufferCount) :
+    std::istream(nullptr) {
+    buffer.reset(new Buffer(open(file.c_str(), O_RDONLY | O_CLOEXEC), true, bufferSize, bufferCount));
+    rdbuf(buffer.get());
+    if (!buffer->isOpen()) {
+        setstate(std::ios_base::failbit);
+    }
+}
+
+PipelinedInput::PipelinedInput(int fd, size_t bufferSize, size_t bufferCount) :
+    std::istream(nullptr) {
+    buffer.reset(new Buffer(fd, false, bufferSize, bufferCount));
+    rdbuf(buffer.get());
+    if (!buffer->isOpen()) {
+        setstate(std::ios_base::failbit);
+    }
+}
+
+PipelinedInput::~PipelinedInput() {}
+
+bool PipelinedInput::isOpen() const {
+    return buffer->isOpen();
+}
+
+int PipelinedInput::getError() const {
+    return buffer->getError();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include <json/key.h>
+
+namespace JSON {
+
+static thread_local KeyTable* currentTable = nullptr;
+
+void Key::setAtom(const Atom* atom) {
+    memset(data, 0, sizeof(data));
+    memcpy(data, &atom, sizeof(atom));
+    data[inlineCapacity] = atomTag;
+}
+
+void Key::setInline(std::string_view key) {
+    memset(data, 0, sizeof(data));
+    if (!key.empty()) {
+        memcpy(data, key.data(), key.size());
+    }
+    data[inlineCapacity] = (char)(inlineCapacity - key.size());
+}
+
+void Key::copy(const Key& key) {
+    if (key.isInline() || key.getAtom()->table != nullptr) {
+        memcpy(data, key.data, sizeof(data));
+    } else {
+        setAtom(new Atom(*key.getAtom()));
+    }
+}
+
+void Key::destroy() {
+    if (!isInline() && getAtom()->table == nullptr) {
+        delete getAtom();
+    }
+}
+
+void Key::create(std::string_view key) {
+    if (key.size() <= inlineCapacity) {
+        setInline(key);
+        return;
+    }
+    size_t keyHash = hash(key);
+    KeyTable* table = KeyTable::getCurrent();
+    setAtom(table != nullptr ? table->intern(key, keyHash) : new Atom{ keyHash, nullptr, std::string(key) });
+}
+
+size_t Key::getAllocatedSize() const {
+    if (isInline() || getAtom()->table != nullptr) {
+        return 0;
+    }
+    return sizeof(Atom) + getAtom()->name.capacity() + 1;
+}
+
+Key::Key(const char* key) {
+    create(key);
+}
+
+Key::Key(const std::string& key) {
+    create(key);
+}
+
+Key::Key(std::string&& key) {
+    if (key.size() <= inlineCapacity || KeyTable::getCurrent() != nullptr) {
+        create(key);
+        return;
+    }
+    // the string is kept by the atom instead of being copied
+    size_t keyHash = hash(key);
+    setAtom(new Atom{ keyHash, nullptr, std::move(key) });
+}
+
+Key::Key(std::string_view key) {
+    create(key);
+}
+
+Key::Key(const Key& key) {
+    copy(key);
+}
+
+Key::Key(Key&& key) noexcept {
+    memcpy(data, key.data, sizeof(data));
+    key.setInline(std::string_view());
+}
+
+Key& Key::operator=(const Key& key) {
+    if (this != &key) {
+        destroy();
+        copy(key);
+    }
+    return *this;
+}
+
+Key& Key::operator=(Key&& key) noexcept {
+    if (this != &key) {
+        destroy();
+        memcpy(data, key.data, sizeof(data));
+        key.setInline(std::string_view());
+    }
+    return *this;
+}
+
+KeyTable::Scope::Scope(KeyTable& table) : previous(currentTable) {
+    currentTable = &table;
+}
+
+KeyTable::Scope::~Scope() {
+    currentTable = previous;
+}
+
+KeyTable* KeyTable::getCurrent() {
+    return currentTable;
+}
+
+// the table is indexed with linear probing, it is kept at most half full
+void KeyTable::rehash(size_t size) {
+    slots.assign(size, nullptr);
+    for (const std::unique_ptr<Key::Atom>& atom : atoms) {
+        size_t i = atom->hash & (size - 1);
+        while (slots[i] != nullptr) {
+            i = (i + 1) & (size - 1);
+        }
+        slots[i] = atom.get();
+    }
+}
+
+const Key::Atom* KeyTable::intern(std::string_view key, size_t hash) {
+
+    if ((atoms.size() + 1) * 2 > slots.size()) {
+        rehash(slots.empty() ? 64 : slots.size() * 2);
+    }
+
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+
+    for (; slots[i] != nullptr; i = (i + 1) & mask) {
+        if (slots[i]->hash == hash && slots[i]->name == key) {
+            return slots[i];
+        }
+    }
+
+    atoms.push_back(std::make_unique<Key::Atom>(Key::Atom{ hash, this, std::string(key) }));
+    slots[i] = atoms.back().get();
+
+    return slots[i];
+}
+
+size_t KeyTable::getSize() const {
+    return atoms.size();
+}
+
+}
+
+std::ostream& operator<<(std::ostream& output, const JSON::Key& key) {
+    return output << key.view();
+}
\ No newline at end of file
@@ -1,7 +1,8 @@
 #include <json/lexer.h>
-#include <sstream>
+#include <json/tape.h>
 #include <cmath>
-#include <cctype>
+#include <cstdio>
+#include <cstring>
 
 namespace JSON {
 
@@ -14,19 +15,71 @@ Lexer::Lexer(std::istream& input) {
 }
 
 void Lexer::setInput(std::istream& input) {
+    setInput(input, Format::TEXT);
+}
+
+void Lexer::setInput(std::istream& input, Format format) {
     this->input = &input;
+    this->format = format;
+    binaryContainers.clear();
+    binaryState = BinaryState::VALUE;
+    tape = nullptr;
     charPos = 0;
-    lineNumber = 1;
+    lineNumber = format == Format::TEXT ? 1 : 0;
     tokenCharPos = charPos;
     tokenLineNumber = lineNumber;
+    offset = 0;
+    tokenOffset = offset;
+    previousTokenEnd = offset;
     carriageReturn = false;
+    status = Status();
+    nextToken();
+}
+
+void Lexer::setInput(const Tape& tape) {
+    input = nullptr;
+    format = Format::TEXT;
+    this->tape = &tape;
+    tapeIndex = 0;
+    charPos = 0;
+    lineNumber = 0;
+    tokenCharPos = charPos;
+    tokenLineNumber = lineNumber;
+    offset = 0;
+    tokenOffset = offset;
+    previousTokenEnd = offset;
+    status = Status();
     nextToken();
 }
 
+void Lexer::setRecorder(Tape* tape) {
+    recorder = tape;
+}
+
+void Lexer::setExceptions(bool exceptions) {
+    this->exceptions = exceptions;
+}
+
+const Status& Lexer::getStatus() const {
+    return status;
+}
+
 double Lexer::getNumberValue() const {
     return numberValue;
 }
 
+NumberType Lexer::getNumberType() const {
+    return numberType;
+}
+
+int64_t Lexer::getIntegerValue() const {
+    return integerValue;
+}
+
+uint64_t Lexer::getUnsignedValue() const {
+    return unsignedValue;
+}
+
 const std::string& Lexer::getStringValue() const {
     return stringValue;
 }
@@ -55,6 +108,18 @@ int Lexer::getTokenLineNumber() const {
     return tokenLineNumber;
 }
 
+size_t Lexer::getOffset() const {
+    return offset;
+}
+
+size_t Lexer::getTokenOffset() const {
+    return tokenOffset;
+}
+
+size_t Lexer::getPreviousTokenEnd() const {
+    return previousTokenEnd;
+}
+
 void Lexer::nextLine() {
     charPos = 0;
     lineNumber++;
@@ -64,31 +129,418 @@ char Lexer::getNextChar() {
     char c;
     if (input != nullptr && input->get(c)) {
         charPos++;
+        offset++;
         return c;
     }
     return '\0';
 }
 
 Lexer::Error::Error(Code code, const Lexer& lexer, char c) : code(code), lineNumber(lexer.getLineNumber()), charPos(lexer.getCharPos()), c(c) {
+    Status status;
+    status.code = (Status::Code)code;
+    status.c = c;
+    status.lineNumber = lineNumber;
+    status.charPos = charPos;
+    message = status.message();
+}
+
+Lexer::Error::Error(const Status& status) : code((Code)status.code), lineNumber(status.lineNumber), charPos(status.charPos), c(status.c) {
+    message = status.message();
+}
+
+bool Lexer::fail(Status::Code code, char c) {
+    status.code = code;
+    status.c = c;
+    status.offset = offset > 0 ? offset - 1 : 0;
+    status.lineNumber = lineNumber;
+    status.charPos = charPos;
+    return false;
+}
+
+Token Lexer::getNextTapeToken() {
+
+    if (tapeIndex >= tape->getSize()) {
+        return Token::END_OF_STREAM;
+    }
+
+    Token token = tape->getToken(tapeIndex);
+
+    switch (token) {
+        case Token::NUMBER:
+            numberType = tape->getNumberType(tapeIndex);
+            numberValue = tape->getNumberValue(tapeIndex);
+            integerValue = tape->getIntegerValue(tapeIndex);
+            unsignedValue = tape->getUnsignedValue(tapeIndex);
+            break;
+        case Token::BOOLEAN: booleanValue = tape->getBooleanValue(tapeIndex); break;
+        case Token::STRING: stringValue = tape->getStringValue(tapeIndex); stringComplete = true; break;
+        default: break;
+    }
+
+    tapeIndex++;
+
+    return token;
+}
+
+int Lexer::getNextByte() {
+    int c = input->rdbuf()->sbumpc();
+    if (c == EOF) {
+        input->setstate(std::ios::eofbit);
+        return EOF;
+    }
+    offset++;
+    return c;
+}
+
+bool Lexer::getNextBytes(char* data, size_t size) {
+    size_t read = input->rdbuf()->sgetn(data, size);
+    offset += read;
+    if (read < size) {
+        input->setstate(std::ios::eofbit);
+        return false;
+    }
+    return true;
+}
 
-    std::ostringstream s;
+bool Lexer::getNextBigEndian(size_t size, uint64_t& value) {
+    unsigned char bytes[8];
+    if (!getNextBytes((char*)bytes, size)) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value = (value << 8) | bytes[i];
+    }
+    return true;
+}
 
-    switch (code) {
-        case INVALID_CHARACTER: s << "invalid character "; if (isprint(c)) s << "'" << c << "'"; else s << (int)c; break;
-        case INVALID_NUMBER: s << "invalid number"; break;
-        case UNTERMINATED_STRING: s << "unterminated string"; break;
-        case INVALID_ESCAPE_SEQUENCE: s << "invalid escape sequence '\\" << c << "'"; break;
-        case INVALID_UNICODE_ESCAPE_SEQUENCE: s << "invalid unicode escape sequence"; break;
-        default: s << "unknown error"; break;
+bool Lexer::getNextBinaryString(uint64_t size) {
+    // the string is read in blocks, so that a corrupted size does not allocate more than the input
+    static const size_t blockSize = 1 << 16;
+    size_t start = stringValue.size();
+    while (size > 0) {
+        size_t block = size < blockSize ? size : blockSize;
+        stringValue.resize(start + block);
+        if (!getNextBytes(&stringValue[start], block)) {
+            return fail(Status::UNTERMINATED_STRING);
+        }
+        start += block;
+        size -= block;
     }
+    stringComplete = true;
+    return true;
+}
 
-    s << " at line " << lineNumber << " (char " << charPos << ")";
+Token Lexer::setUnsigned(uint64_t value) {
+    if (value <= INT64_MAX) {
+        numberType = NumberType::INT64;
+        integerValue = value;
+    } else {
+        numberType = NumberType::UINT64;
+        unsignedValue = value;
+    }
+    numberValue = value;
+    return Token::NUMBER;
+}
 
-    message = s.str();
+Token Lexer::setInteger(int64_t value) {
+    numberType = NumberType::INT64;
+    integerValue = value;
+    numberValue = value;
+    return Token::NUMBER;
+}
+
+Token Lexer::startBinaryContainer(bool object, uint64_t size) {
+    binaryContainers.push_back({ object, true, size });
+    binaryState = BinaryState::SEPARATOR;
+    return object ? Token::OBJECT_START : Token::ARRAY_START;
+}
+
+// the size of the containers of indefinite length, which end with a break byte
+static const uint64_t indefiniteSize = UINT64_MAX;
+static const int cborBreak = 0xFF;
+
+static double decodeHalf(uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value = exponent == 0 ? std::ldexp(mantissa, -24) :
+        exponent != 31 ? std::ldexp(mantissa + 1024, exponent - 25) :
+        mantissa == 0 ? INFINITY : NAN;
+    return half & 0x8000 ? -value : value;
+}
+
+Token Lexer::getNextCborItem(bool key) {
+
+    int c;
+    int major;
+    int info;
+    uint64_t argument;
+
+    // the tags only give a meaning to the next item, they are skipped in a loop since an input can chain many
+    do {
+        tokenOffset = offset;
+
+        c = getNextByte();
+        if (c == EOF) {
+            return Token::END_OF_STREAM;
+        }
+
+        // the head of an item holds its major type and an argument, which is its value or its size
+        major = c >> 5;
+        info = c & 0x1F;
+        argument = indefiniteSize;
+
+        if (info >= 24 && info <= 27) {
+            if (!getNextBigEndian(1 << (info - 24), argument)) {
+                return fail(Status::INVALID_NUMBER), Token::INVALID;
+            }
+        } else if (info < 24) {
+            argument = info;
+        } else if (info != 31 || major < 2 || major > 5) {
+            return fail(Status::INVALID_CHARACTER, (char)c), Token::INVALID;
+        }
+    } while (major == 6);
+
+    switch (major) {
+        case 0:
+            return setUnsigned(argument);
+        case 1:
+            if (argument <= INT64_MAX) {
+                return setInteger(-1 - (int64_t)argument);
+            }
+            numberType = NumberType::DOUBLE;
+            numberValue = -1.0 - (double)argument;
+            return Token::NUMBER;
+        case 2:
+        case 3:
+            stringValue.clear();
+            if (argument != indefiniteSize) {
+                return getNextBinaryString(argument) ? Token::STRING : Token::INVALID;
+            }
+            // a string of indefinite length is a sequence of strings of the same type
+            while ((c = getNextByte()) != cborBreak) {
+                if (c == EOF) {
+                    return fail(Status::UNTERMINATED_STRING), Token::INVALID;
+                }
+                if (c >> 5 != major || (c & 0x1F) > 27) {
+                    return fail(Status::INVALID_CHARACTER, (char)c), Token::INVALID;
+                }
+                argument = c & 0x1F;
+                if (argument >= 24 && !getNextBigEndian(1 << (argument - 24), argument)) {
+                    return fail(Status::UNTERMINATED_STRING), Token::INVALID;
+                }
+                if (!getNextBinaryString(argument)) {
+                    return Token::INVALID;
+                }
+            }
+            stringComplete = true;
+            return Token::STRING;
+        case 4:
+        case 5:
+            if (key) {
+                return fail(Status::INVALID_CHARACTER, (char)c), Token::INVALID;
+            }
+            return startBinaryContainer(major == 5, argument);
+        default:
+            break;
+    }
+
+    float single;
+    uint32_t bits = (uint32_t)argument;
+
+    switch (info) {
+        case 20: return booleanValue = false, Token::BOOLEAN;
+        case 21: return booleanValue = true, Token::BOOLEAN;
+        case 22: return Token::NULL_;
+        case 23: return Token::NULL_;
+        case 25: numberValue = decodeHalf((uint16_t)argument); break;
+        case 26: memcpy(&single, &bits, sizeof(single)); numberValue = single; break;
+        case 27: memcpy(&numberValue, &argument, sizeof(numberValue)); break;
+        default: return fail(Status::INVALID_CHARACTER, (char)c), Token::INVALID;
+    }
+
+    numberType = NumberType::DOUBLE;
+    return Token::NUMBER;
+}
+
+Token Lexer::getNextMessagePackItem(bool key) {
+
+    tokenOffset = offset;
+
+    int c = getNextByte();
+    if (c == EOF) {
+        return Token::END_OF_STREAM;
+    }
+
+    // fixed size types hold their value or their size in the first byte
+    if (c <= 0x7F) {
+        return setUnsigned(c);
+    }
+    if (c >= 0xE0) {
+        return setInteger((int8_t)c);
+    }
+    if (c <= 0x9F && key) {
+        return fail(Status::INVALID_CHARACTER, (char)c), Token::INVALID;
+    }
+    if (c <= 0x8F) {
+        return startBinaryContainer(true, c & 0x0F);
+    }
+    if (c <= 0x9F) {
+        return startBinaryContainer(false, c & 0x0F);
+    }
+    if (c <= 0xBF) {
+        stringValue.clear();
+        return getNextBinaryString(c & 0x1F) ? Token::STRING : Token::INVALID;
+    }
+
+    switch (c) {
+        case 0xC0: return Token::NULL_;
+        case 0xC2: return booleanValue = false, Token::BOOLEAN;
+        case 0xC3: return booleanValue = true, Token::BOOLEAN;
+        default: break;
+    }
+
+    // the other types are followed by a value or a size of 1 to 8 bytes
+    size_t size;
+    switch (c) {
+        case 0xCC: case 0xD0: case 0xD9: case 0xC4: size = 1; break;
+        case 0xCD: case 0xD1: case 0xDA: case 0xC5: case 0xDC: case 0xDE: size = 2; break;
+        case 0xCE: case 0xD2: case 0xDB: case 0xC6: case 0xDD: case 0xDF: case 0xCA: size = 4; break;
+        case 0xCF: case 0xD3: case 0xCB: size = 8; break;
+        default: return fail(Status::INVALID_CHARACTER, (char)c), Token::INVALID;
+    }
+
+    uint64_t argument;
+    if (!getNextBigEndian(size, argument)) {
+        // a truncated size of a string or binary is an unterminated string, the other truncated heads are reported as in CBOR
+        bool string = (c >= 0xC4 && c <= 0xC6) || (c >= 0xD9 && c <= 0xDB);
+        return fail(string ? Status::UNTERMINATED_STRING : Status::INVALID_NUMBER), Token::INVALID;
+    }
+
+    float single;
+    uint32_t bits = (uint32_t)argument;
+
+    switch (c) {
+        case 0xCA:
+            memcpy(&single, &bits, sizeof(single));
+            numberType = NumberType::DOUBLE;
+            numberValue = single;
+            return Token::NUMBER;
+        case 0xCB:
+            numberType = NumberType::DOUBLE;
+            memcpy(&numberValue, &argument, sizeof(numberValue));
+            return Token::NUMBER;
+        case 0xCC: case 0xCD: case 0xCE: case 0xCF:
+            return setUnsigned(argument);
+        case 0xD0: case 0xD1: case 0xD2: case 0xD3:
+            // the sign is extended from the size of the integer
+            return setInteger((int64_t)(argument << (64 - 8 * size)) >> (64 - 8 * size));
+        case 0xDC: case 0xDD:
+        case 0xDE: case 0xDF:
+            if (key) {
+                return fail(Status::INVALID_CHARACTER, (char)c), Token::INVALID;
+            }
+            return startBinaryContainer(c >= 0xDE, argument);
+        default:
+            stringValue.clear();
+            return getNextBinaryString(argument) ? Token::STRING : Token::INVALID;
+    }
+}
+
+Token Lexer::getNextBinaryToken() {
+
+    switch (binaryState) {
+
+        case BinaryState::COLON:
+            tokenOffset = offset;
+            binaryState = BinaryState::VALUE;
+            return Token::COLON;
+
+        case BinaryState::SEPARATOR: {
+            // the end of the container, or a comma before the next item
+            tokenOffset = offset;
+            BinaryContainer& container = binaryContainers.back();
+            bool end = container.remaining == indefiniteSize ?
+                format == Format::CBOR && input->rdbuf()->sgetc() == cborBreak :
+                container.remaining == 0;
+            if (end) {
+                if (container.remaining == indefiniteSize) {
+                    getNextByte();
+                }
+                Token token = container.object ? Token::OBJECT_END : Token::ARRAY_END;
+                binaryContainers.pop_back();
+                binaryState = binaryContainers.empty() ? BinaryState::END : BinaryState::SEPARATOR;
+                return token;
+            }
+            if (container.remaining != indefiniteSize) {
+                container.remaining--;
+            }
+            binaryState = container.object ? BinaryState::KEY : BinaryState::VALUE;
+            if (!container.first) {
+                return Token::COMMA;
+            }
+            container.first = false;
+            return getNextBinaryToken();
+        }
+
+        case BinaryState::KEY: {
+            Token token = format == Format::CBOR ? getNextCborItem(true) : getNextMessagePackItem(true);
+            if (token == Token::NUMBER && numberType != NumberType::DOUBLE) {
+                stringValue = numberType == NumberType::INT64 ? std::to_string(integerValue) : std::to_string(unsignedValue);
+                token = Token::STRING;
+            } else if (token != Token::STRING && token != Token::INVALID && token != Token::END_OF_STREAM) {
+                // only strings and integers can be converted to keys
+                return fail(Status::INVALID_CHARACTER), Token::INVALID;
+            }
+            if (token == Token::STRING) {
+                binaryState = BinaryState::COLON;
+            }
+            return token;
+        }
+
+        case BinaryState::VALUE: {
+            Token token = format == Format::CBOR ? getNextCborItem(false) : getNextMessagePackItem(false);
+            if (token != Token::OBJECT_START && token != Token::ARRAY_START && token != Token::INVALID && token != Token::END_OF_STREAM) {
+                binaryState = binaryContainers.empty() ? BinaryState::END : BinaryState::SEPARATOR;
+            }
+            return token;
+        }
+
+        default:
+            tokenOffset = offset;
+            return Token::END_OF_STREAM;
+    }
+}
+
+void Lexer::recordToken() {
+    switch (token) {
+        case Token::NUMBER:
+            switch (numberType) {
+                case NumberType::INT64: recorder->appendInteger(integerValue); break;
+                case NumberType::UINT64: recorder->appendUnsigned(unsignedValue); break;
+                default: recorder->appendNumber(numberValue); break;
+            }
+            break;
+        case Token::BOOLEAN: recorder->appendBoolean(booleanValue); break;
+        case Token::STRING: recorder->appendString(stringValue); break;
+        case Token::END_OF_STREAM: break;
+        case Token::INVALID: break;
+        default: recorder->appendToken(token); break;
+    }
 }
 
 Token Lexer::getNextToken() {
 
+    if (tape != nullptr) {
+        return getNextTapeToken();
+    }
+
+    if (format != Format::TEXT) {
+        return getNextBinaryToken();
+    }
+
+    tokenOffset = offset;
+
     char c = getNextChar();
 
     if (c == ' ' || c == '\t') {
@@ -141,11 +593,11 @@ Token Lexer::getNextToken() {
     }
 
     if (c == '\"') {
-        return getNextString(), Token::STRING;
+        return getNextString() ? Token::STRING : Token::INVALID;
     }
 
     if (c == '-' || (c >= '0' && c <= '9')) {
-        return getNextNumber(c), Token::NUMBER;
+        return getNextNumber(c) ? Token::NUMBER : Token::INVALID;
     }
 
     if (c == 't') {
@@ -166,20 +618,105 @@ Token Lexer::getNextToken() {
         }
     }
 
-    throw Error(Error::INVALID_CHARACTER, *this, c);
+    return fail(Status::INVALID_CHARACTER, c), Token::INVALID;
 }
 
 void Lexer::nextToken() {
+    previousTokenEnd = offset;
     token = getNextToken();
+    if (recorder != nullptr) {
+        recordToken();
+    }
+    if (token == Token::INVALID && exceptions) {
+        throw Error(status);
+    }
+}
+
+void Lexer::skipContainer() {
+
+    previousTokenEnd = offset;
+    int depth = 1;
+
+    if (tape != nullptr) {
+        for (; depth > 0 && tapeIndex < tape->getSize(); tapeIndex++) {
+            switch (tape->getToken(tapeIndex)) {
+                case Token::OBJECT_START: case Token::ARRAY_START: depth++; break;
+                case Token::OBJECT_END: case Token::ARRAY_END: depth--; break;
+                default: break;
+            }
+        }
+        token = depth == 0 ? tape->getToken(tapeIndex - 1) : Token::END_OF_STREAM;
+        return;
+    }
+
+    if (format != Format::TEXT) {
+        // the items of a binary input are decoded, they are not found by scanning the bytes
+        while (depth > 0) {
+            token = getNextBinaryToken();
+            switch (token) {
+                case Token::OBJECT_START: case Token::ARRAY_START: depth++; break;
+                case Token::OBJECT_END: case Token::ARRAY_END: depth--; break;
+                case Token::INVALID: if (exceptions) throw Error(status); return;
+                case Token::END_OF_STREAM: return;
+                default: break;
+            }
+        }
+        return;
+    }
+
+    // read the buffer directly, this is much faster than getNextChar()
+    std::streambuf* buffer = input != nullptr ? input->rdbuf() : nullptr;
+    bool inString = false;
+    int c = 0;
+
+    while (depth > 0) {
+        c = buffer != nullptr ? buffer->sbumpc() : EOF;
+        if (c == EOF) {
+            if (input != nullptr) {
+                input->setstate(std::ios::eofbit);
+            }
+            tokenOffset = offset;
+            tokenCharPos = charPos;
+            tokenLineNumber = lineNumber;
+            token = Token::END_OF_STREAM;
+            return;
+        }
+        offset++;
+        charPos++;
+        if (inString) {
+            if (c == '\\') {
+                if (buffer->sbumpc() != EOF) {
+                    offset++;
+                    charPos++;
+                }
+            } else if (c == '\"') {
+                inString = false;
+            }
+            continue;
+        }
+        switch (c) {
+            case '\"': inString = true; break;
+            case '{': case '[': depth++; break;
+            case '}': case ']': depth--; break;
+            case '\n': nextLine(); break;
+        }
+    }
+
+    tokenOffset = offset - 1;
+    tokenCharPos = charPos;
+    tokenLineNumber = lineNumber;
+    token = c == '}' ? Token::OBJECT_END : Token::ARRAY_END;
 }
 
 Token Lexer::getToken() const {
     return token;
 }
 
-void Lexer::getNextNumber(char c) {
+bool Lexer::getNextNumber(char c) {
 
     double sign = 1, intPart = 0, fracPart = 0, exponent = 0, exponentSign = 1;
+    uint64_t integer = 0;
+    bool exact = true;
 
     if (c == '-') {
         sign = -1;
@@ -192,14 +729,20 @@ void Lexer::getNextNumber(char c) {
     else if (c >= '1' && c <= '9') {
         do {
             intPart = (intPart * 10) + (c - '0');
+            // the integer part is also kept exactly while it fits in 64 bits
+            if (integer > (UINT64_MAX - (c - '0')) / 10) {
+                exact = false;
+            }
+            integer = integer * 10 + (c - '0');
             c = getNextChar();
         } while (c >= '0' && c <= '9');
     }
     else {
-        throw Error(Error::INVALID_NUMBER, *this);
+        return fail(Status::INVALID_NUMBER);
     }
 
     if (c == '.') {
+        exact = false;
         c = getNextChar();
         if (c >= '0' && c <= '9') {
             double prec = 10;
@@ -210,12 +753,13 @@ void Lexer::getNextNumber(char c) {
             } while (c >= '0' && c <= '9');
         }
         else {
-            throw Error(Error::INVALID_NUMBER, *this);
+            return fail(Status::INVALID_NUMBER);
         }
     }
 
     if (c == 'e' || c == 'E') {
 
+        exact = false;
         c = getNextChar();
 
         if (c == '-') {
@@ -233,18 +777,62 @@ void Lexer::getNextNumber(char c) {
             } while (c >= '0' && c <= '9');
         }
         else {
-            throw Error(Error::INVALID_NUMBER, *this);
+            return fail(Status::INVALID_NUMBER);
         }
     }
 
-    numberValue = sign * (intPart + fracPart) * pow(10, exponentSign * exponent);
+    // -0 is kept as a double to keep its sign
+    if (exact && sign > 0 && integer <= INT64_MAX) {
+        numberType = NumberType::INT64;
+        integerValue = integer;
+        numberValue = integer;
+    }
+    else if (exact && sign > 0) {
+        numberType = NumberType::UINT64;
+        unsignedValue = integer;
+        numberValue = integer;
+    }
+    else if (exact && integer != 0 && integer - 1 <= INT64_MAX) {
+        numberType = NumberType::INT64;
+        integerValue = -(int64_t)(integer - 1) - 1;
+        numberValue = integerValue;
+    }
+    else {
+        numberType = NumberType::DOUBLE;
+        numberValue = sign * (intPart + fracPart) * pow(10, exponentSign * exponent);
+    }
 
-    charPos--;
-    
-    input->unget();
+    if (input->good()) {
+        charPos--;
+        offset--;
+        input->unget();
+    }
+
+    return true;
+}
+
+void Lexer::setStringChunkSize(size_t size) {
+    stringChunkSize = size;
 }
 
-void Lexer::getNextString() {
+bool Lexer::isStringComplete() const {
+    return stringComplete;
+}
+
+void Lexer::nextStringChunk() {
+    if (getNextString()) {
+        if (recorder != nullptr) {
+            recorder->appendStringChunk(stringValue);
+        }
+    } else {
+        token = Token::INVALID;
+        if (exceptions) {
+            throw Error(status);
+        }
+    }
+}
+
+bool Lexer::getNextString() {
 
     stringValue.clear();
 
@@ -252,10 +840,19 @@ void Lexer::getNextString() {
 
     while (true) {
 
+        // stop the chunk before a character that is not the end of the string or of a UTF-8 sequence
+        if (stringChunkSize > 0 && !escape && stringValue.size() >= stringChunkSize) {
+            int next = input->peek();
+            if (next != '\"' && (next & 0xC0) != 0x80) {
+                stringComplete = false;
+                return true;
+            }
+        }
+
         char c = getNextChar();
 
         if (c == '\0') {
-            throw Error(Error::UNTERMINATED_STRING, *this);
+            return fail(Status::UNTERMINATED_STRING);
         }
 
         else if (escape) {
@@ -303,7 +900,7 @@ void Lexer::getNextString() {
                         code = (code << 4) | (c - 'a' + 10);
                     }
                     else {
-                        throw Error(Error::INVALID_UNICODE_ESCAPE_SEQUENCE, *this);
+                        return fail(Status::INVALID_UNICODE_ESCAPE_SEQUENCE);
                     }
                 }
 
@@ -322,7 +919,7 @@ void Lexer::getNextString() {
             }
 
             else {
-                throw Error(Error::INVALID_ESCAPE_SEQUENCE, *this);
+                return fail(Status::INVALID_ESCAPE_SEQUENCE, c);
             }
 
             escape = false;
@@ -333,11 +930,12 @@ void Lexer::getNextString() {
         }
 
         else if (c == '\"') {
-            return;
+            stringComplete = true;
+            return true;
         }
 
         else if (c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t') {
-            throw Error(Error::INVALID_CHARACTER, *this, c);
+            return fail(Status::INVALID_CHARACTER, c);
         }
 
         else {
@@ -362,6 +960,7 @@ std::ostream& operator<<(std::ostream& stream, JSON::Token token) {
         case JSON::Token::BOOLEAN: return stream << "BOOLEAN";
         case JSON::Token::NULL_: return stream << "NULL";
         case JSON::Token::END_OF_STREAM: return stream << "END_OF_STREAM";
+        case JSON::Token::INVALID: return stream << "INVALID";
         default: return stream << "ERROR";
     }
 }
\ No newline at end of file
@@ -1,104 +1,295 @@
 #include <json/parser.h>
 #include <json/lexer.h>
 #include <json/path/cursor.h>
-#include <sstream>
 
 namespace JSON {
 
+void Parser::throwError(const Status& status) {
+    if (status.code == Status::UNEXPECTED_TOKEN) {
+        throw Error(status);
+    }
+    throw Lexer::Error(status);
+}
+
+const Lexer& Parser::getLexer() const {
+    return lexer;
+}
+
 size_t Parser::getDepth() const {
     return depth;
 }
 
-void Parser::parse(std::istream& input, const Path& path) {
+void Parser::reset(bool exceptions) {
+    this->exceptions = exceptions;
     depth = 0;
-    lexer.setInput(input);
+    status = Status();
+    lexer.setExceptions(false);
+    lexer.setStringChunkSize(stringChunkSize);
+    lexer.setRecorder(recorder);
+}
+
+bool Parser::parseRoot(const Path& path) {
     Path::Cursor cursor(path);
-    parseValue(cursor);
+    if (!parseValue(cursor)) {
+        return false;
+    }
+    if (lexer.getToken() == Token::INVALID) {
+        return fail();
+    }
+    return true;
+}
+
+void Parser::parse(std::istream& input, const Path& path) {
+    reset(true);
+    lexer.setInput(input);
+    if (!parseRoot(path)) {
+        throwError(status);
+    }
+}
+
+Status Parser::tryParse(std::istream& input, const Path& path) {
+    reset(false);
+    lexer.setInput(input);
+    parseRoot(path);
+    return status;
+}
+
+void Parser::parse(std::istream& input, Format format, const Path& path) {
+    reset(true);
+    lexer.setInput(input, format);
+    if (!parseRoot(path)) {
+        throwError(status);
+    }
+}
+
+Status Parser::tryParse(std::istream& input, Format format, const Path& path) {
+    reset(false);
+    lexer.setInput(input, format);
+    parseRoot(path);
+    return status;
 }
 
-void Parser::delegate(Parser& parser, const Path& path) {
+void Parser::parse(const Tape& tape, const Path& path) {
+    reset(true);
+    lexer.setInput(tape);
+    if (!parseRoot(path)) {
+        throwError(status);
+    }
+}
+
+Status Parser::tryParse(const Tape& tape, const Path& path) {
+    reset(false);
+    lexer.setInput(tape);
+    parseRoot(path);
+    return status;
+}
+
+void Parser::setRecorder(Tape* tape) {
+    recorder = tape;
+}
+
+void Parser::setStringChunkSize(size_t size) {
+    stringChunkSize = size;
+}
+
+void Parser::onInteger(int64_t number) {
+    onNumber(number);
+}
+
+void Parser::onUnsigned(uint64_t number) {
+    onNumber(number);
+}
+
+void Parser::onStringStart() {
+    stringBuffer.clear();
+}
+
+void Parser::onStringChunk(std::string& chunk) {
+    stringBuffer += chunk;
+}
+
+void Parser::onStringEnd() {
+    onString(stringBuffer);
+}
+
+
+bool Parser::delegate(Parser& parser, const Path& path) {
+    parser.exceptions = exceptions;
     parser.depth = 0;
+    parser.status = Status();
     parser.lexer = lexer;
     Path::Cursor cursor(path);
-    parser.parseValue(cursor);
+    bool success = parser.parseValue(cursor) && (parser.lexer.getToken() != Token::INVALID || parser.fail());
     lexer = parser.lexer;
     delegated = true;
+    if (!success) {
+        status = parser.status;
+        if (exceptions) {
+            throwError(status);
+        }
+    }
+    return success;
 }
 
 Parser::Error::Error(const Lexer& lexer) :
     token(lexer.getToken()), linePos(lexer.getTokenLineNumber()), charPos(lexer.getTokenCharPos()) {
-    std::ostringstream s;
-    s << "unexpected token " << token << " at line " << linePos << " (char " << charPos << ")";
-    message = s.str();
+    Status status;
+    status.code = Status::UNEXPECTED_TOKEN;
+    status.token = token;
+    status.lineNumber = linePos;
+    status.charPos = charPos;
+    message = status.message();
 }
 
-void Parser::expectToken(Token expectedToken) {
+Parser::Error::Error(const Status& status) :
+    token(status.token), linePos(status.lineNumber), charPos(status.charPos) {
+    message = status.message();
+}
+
+bool Parser::fail() {
+    if (lexer.getToken() == Token::INVALID) {
+        status = lexer.getStatus();
+    } else {
+        status.code = Status::UNEXPECTED_TOKEN;
+        status.token = lexer.getToken();
+        status.offset = lexer.getTokenOffset();
+        status.lineNumber = lexer.getTokenLineNumber();
+        status.charPos = lexer.getTokenCharPos();
+    }
+    return false;
+}
+
+bool Parser::completeString(std::string& string) {
+    while (!lexer.isStringComplete()) {
+        lexer.nextStringChunk();
+        if (lexer.getToken() == Token::INVALID) {
+            return fail();
+        }
+        string += lexer.getStringValue();
+    }
+    return true;
+}
+
+bool Parser::expectToken(Token expectedToken) {
     if (lexer.getToken() != expectedToken) {
-        throw Error(lexer);
+        return fail();
     }
     lexer.nextToken();
+    return true;
 }
 
-void Parser::parseValue(Path::Cursor& cursor) {
-    
+bool Parser::parseValue(Path::Cursor& cursor) {
+
     switch (lexer.getToken()) {
 
         case Token::OBJECT_START:
             if (cursor.isInTarget()) onObjectStart();
             depth++;
-            parseObject(cursor);
+            if (!parseObject(cursor)) return false;
             depth--;
             if (cursor.isInTarget()) onObjectEnd();
-            break;
-        
+            return true;
+
         case Token::ARRAY_START:
             if (cursor.isInTarget()) onArrayStart();
             depth++;
-            parseArray(cursor);
+            if (!parseArray(cursor)) return false;
             depth--;
             if (cursor.isInTarget()) onArrayEnd();
-            break;
-        
+            return true;
+
         case Token::NUMBER:
-            if (cursor.isInTarget()) onNumber(lexer.getNumberValue());
+            if (cursor.isInTarget()) {
+                switch (lexer.getNumberType()) {
+                    case NumberType::INT64: onInteger(lexer.getIntegerValue()); break;
+                    case NumberType::UINT64: onUnsigned(lexer.getUnsignedValue()); break;
+                    default: onNumber(lexer.getNumberValue()); break;
+                }
+            }
             lexer.nextToken();
-            break;
+            return true;
 
         case Token::BOOLEAN:
             if (cursor.isInTarget()) onBoolean(lexer.getBooleanValue());
             lexer.nextToken();
-            break;
-        
+            return true;
+
         case Token::STRING:
-            if (cursor.isInTarget()) onString(lexer.getStringValue());
+            if (!lexer.isStringComplete()) {
+                if (!parseStringChunks(cursor)) return false;
+            }
+            else if (cursor.isInTarget()) onString(lexer.getStringValue());
             lexer.nextToken();
-            break;
+            return true;
 
         case Token::NULL_:
             if (cursor.isInTarget()) onNull();
             lexer.nextToken();
-            break;
-        
+            return true;
+
         default:
-            throw Error(lexer);
+            return fail();
     }
 }
 
-void Parser::parseObject(Path::Cursor& cursor) {
+bool Parser::parseStringChunks(Path::Cursor& cursor) {
+
+    bool target = cursor.isInTarget();
+
+    if (target) {
+        onStringStart();
+    }
+
+    while (true) {
+        if (target) {
+            onStringChunk(lexer.getStringValue());
+        }
+        if (lexer.isStringComplete()) {
+            break;
+        }
+        lexer.nextStringChunk();
+        if (lexer.getToken() == Token::INVALID) {
+            return fail();
+        }
+    }
+
+    if (target) {
+        onStringEnd();
+    }
+
+    return true;
+}
+
+bool Parser::parseDelegatedValue(Path::Cursor& cursor) {
+    if (delegated) {
+        delegated = false;
+        return status.ok();
+    }
+    return parseValue(cursor);
+}
+
+bool Parser::parseObject(Path::Cursor& cursor) {
 
     lexer.nextToken();
-    
+
     switch (lexer.getToken()) {
 
         case Token::OBJECT_END:
             lexer.nextToken();
-            break;
+            return true;
 
         case Token::STRING:
             {
-                std::string key = std::move(lexer.getStringValue());
+                // the key is swapped with the last one so that the lexer keeps a buffer for the next string
+                std::string& key = keyBuffer;
+                key.swap(lexer.getStringValue());
+                if (!completeString(key)) {
+                    return false;
+                }
                 lexer.nextToken();
-                expectToken(Token::COLON);
+                if (!expectToken(Token::COLON)) {
+                    return false;
+                }
                 if (cursor.isInTarget()) {
                     cursor.next(key);
                     onKey(key);
@@ -106,32 +297,41 @@ void Parser::parseObject(Path::Cursor& cursor) {
                     cursor.next(key);
                 }
             }
-            if (!delegated) {
-                parseValue(cursor);
+            if (!parseDelegatedValue(cursor)) {
+                return false;
             }
-            delegated = false;
             cursor.prev();
             return parseNonEmptyObject(cursor);
 
         default:
-            throw Error(lexer);
+            return fail();
     }
 }
 
-void Parser::parseNonEmptyObject(Path::Cursor& cursor) {
-    
+bool Parser::parseNonEmptyObject(Path::Cursor& cursor) {
+
     switch (lexer.getToken()) {
 
         case Token::OBJECT_END:
             lexer.nextToken();
-            break;
+            return true;
 
         case Token::COMMA:
             lexer.nextToken();
             {
-                std::string key = std::move(lexer.getStringValue());
-                expectToken(Token::STRING);
-                expectToken(Token::COLON);
+                if (lexer.getToken() != Token::STRING) {
+                    return fail();
+                }
+                // the key is swapped with the last one so that the lexer keeps a buffer for the next string
+                std::string& key = keyBuffer;
+                key.swap(lexer.getStringValue());
+                if (!completeString(key)) {
+                    return false;
+                }
+                lexer.nextToken();
+                if (!expectToken(Token::COLON)) {
+                    return false;
+                }
                 if (cursor.isInTarget()) {
                     cursor.next(key);
                     onKey(key);
@@ -139,19 +339,18 @@ void Parser::parseNonEmptyObject(Path::Cursor& cursor) {
                     cursor.next(key);
                 }
             }
-            if (!delegated) {
-                parseValue(cursor);
+            if (!parseDelegatedValue(cursor)) {
+                return false;
             }
-            delegated = false;
             cursor.prev();
             return parseNonEmptyObject(cursor);
 
         default:
-            throw Error(lexer);
+            return fail();
     }
 }
 
-void Parser::parseArray(Path::Cursor& cursor) {
+bool Parser::parseArray(Path::Cursor& cursor) {
 
     lexer.nextToken();
 
@@ -159,7 +358,7 @@ void Parser::parseArray(Path::Cursor& cursor) {
 
         case Token::ARRAY_END:
             lexer.nextToken();
-            break;
+            return true;
 
         default:
             if (cursor.isInTarget()) {
@@ -168,23 +367,22 @@ void Parser::parseArray(Path::Cursor& cursor) {
             } else {
                 cursor.next(0);
             }
-            if (!delegated) {
-                parseValue(cursor);
+            if (!parseDelegatedValue(cursor)) {
+                return false;
             }
-            delegated = false;
             cursor.prev();
             return parseNonEmptyArray(cursor);
     }
 }
 
-void Parser::parseNonEmptyArray(Path::Cursor& cursor, size_t index) {
+bool Parser::parseNonEmptyArray(Path::Cursor& cursor, size_t index) {
 
     switch (lexer.getToken()) {
 
         case Token::ARRAY_END:
             lexer.nextToken();
-            break;
-        
+            return true;
+
         case Token::COMMA:
             lexer.nextToken();
             if (cursor.isInTarget()) {
@@ -193,15 +391,14 @@ void Parser::parseNonEmptyArray(Path::Cursor& cursor, size_t index) {
             } else {
                 cursor.next(index);
             }
-            if (!delegated) {
-                parseValue(cursor);
+            if (!parseDelegatedValue(cursor)) {
+                return false;
             }
-            delegated = false;
             cursor.prev();
             return parseNonEmptyArray(cursor, index + 1);
 
         default:
-            throw Error(lexer);
+            return fail();
     }
 }
 
@@ -0,0 +1,632 @@
+#include <json/patch.h>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+namespace JSON {
+
+PatchError::PatchError(size_t index, const std::string& reason) : index(index) {
+    std::ostringstream s;
+    s << "patch operation " << index << " failed: " << reason;
+    message = s.str();
+}
+
+/**
+ * The unescaped reference tokens of a JSON Pointer.
+ */
+using Pointer = std::vector<std::string>;
+
+/**
+ * Appends a reference token to a JSON Pointer, '~' is escaped as "~0" and '/' as "~1".
+ */
+static void appendToken(std::string& pointer, std::string_view token) {
+    pointer += '/';
+    for (char c : token) {
+        switch (c) {
+            case '~': pointer += "~0"; break;
+            case '/': pointer += "~1"; break;
+            default: pointer += c; break;
+        }
+    }
+}
+
+/**
+ * Splits a JSON Pointer into its reference tokens.
+ * Returns false if the pointer is not valid.
+ */
+static bool parsePointer(const std::string& pointer, Pointer& tokens) {
+    tokens.clear();
+    if (pointer.empty()) {
+        return true;
+    }
+    if (pointer[0] != '/') {
+        return false;
+    }
+    for (size_t i = 0; i < pointer.size(); i++) {
+        char c = pointer[i];
+        if (c == '/') {
+            tokens.emplace_back();
+        } else if (c != '~') {
+            tokens.back() += c;
+        } else if (i + 1 < pointer.size() && (pointer[i + 1] == '0' || pointer[i + 1] == '1')) {
+            tokens.back() += pointer[++i] == '0' ? '~' : '/';
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Reads an array index, which is a decimal number without leading zeros.
+ */
+static bool parseIndex(const std::string& token, size_t& index) {
+    if (token.empty() || token.size() > 18 || (token[0] == '0' && token.size() > 1)) {
+        return false;
+    }
+    index = 0;
+    for (char c : token) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        index = index * 10 + (c - '0');
+    }
+    return true;
+}
+
+/**
+ * Returns the value at the first tokens of a pointer, or nullptr if it does not exist.
+ * The containers on the way are accessed through non-const methods if the root is not const.
+ */
+template <class V>
+static V* findValue(V& root, const Pointer& pointer, size_t count) {
+    V* value = &root;
+    for (size_t i = 0; i < count; i++) {
+        size_t index;
+        if (value->getType() == Type::OBJECT) {
+            auto& object = value->getObjectValue();
+            auto it = object.find(pointer[i]);
+            if (it == object.end()) {
+                return nullptr;
+            }
+            value = &it->second;
+        } else if (value->getType() == Type::ARRAY) {
+            auto& array = value->getArrayValue();
+            if (!parseIndex(pointer[i], index) || index >= array.size()) {
+                return nullptr;
+            }
+            value = &array[index];
+        } else {
+            return nullptr;
+        }
+    }
+    return value;
+}
+
+/**
+ * Builds the operations of a patch while walking the source and the target together.
+ * The pointer to the current values is extended and truncated in place.
+ */
+class Differ {
+
+    enum class Edit : unsigned char {
+        KEEP,
+        REMOVE,
+        INSERT
+    };
+
+    Array& operations;
+    size_t maxArrayEdits;
+    std::string pointer;
+    std::unordered_map<const Value*, size_t> hashes;
+
+    void addOperation(const char* op, const Value* value = nullptr) {
+        Object operation;
+        operation[Key("op")] = String(op);
+        operation[Key("path")] = pointer;
+        if (value != nullptr) {
+            operation[Key("value")] = value->share();
+        }
+        operations.emplace_back(std::move(operation));
+    }
+
+    /**
+     * Returns the hash of a value, which is computed once per container during the walk, since the values
+     * are not modified and the hashes of unshared values are not cached by the values themselves (see Value::hash).
+     * The other values are cheap to hash and are not remembered, since the elements read from packed arrays
+     * are temporary (see getElements).
+     */
+    size_t hash(const Value& value) {
+        if (!value.hasType(Type::OBJECT) && !value.hasType(Type::ARRAY)) {
+            return value.hash();
+        }
+        auto it = hashes.find(&value);
+        if (it == hashes.end()) {
+            it = hashes.emplace(&value, value.hash()).first;
+        }
+        return it->second;
+    }
+
+    /**
+     * Compares the hashes of the values before their content, so that the elements of the arrays
+     * compared many times by findEdits are hashed once.
+     */
+    bool same(const Value& first, const Value& second) {
+        return hash(first) == hash(second) && first == second;
+    }
+
+    /**
+     * Returns the elements of an array, which are copied to the given array if the array is packed
+     * rather than read from the array of values it keeps for compatibility (see Value::pack).
+     */
+    static const Array& getElements(const Value& value, Array& elements) {
+        if (!value.isPacked()) {
+            return value.getArrayValue();
+        }
+        size_t size = value.getArraySize();
+        elements.reserve(size);
+        for (size_t index = 0; index < size; index++) {
+            elements.push_back(value.getElement(index));
+        }
+        return elements;
+    }
+
+    void compareObjects(const Object& source, const Object& target) {
+
+        size_t length = pointer.size();
+
+#if defined(JSON_HASH_OBJECT)
+        // the members are in insertion order, so they are looked up in the other object
+        for (const auto& item : source) {
+            auto it = target.find(item.first.view());
+            appendToken(pointer, item.first.view());
+            if (it == target.end()) {
+                addOperation("remove");
+            } else {
+                compare(item.second, it->second);
+            }
+            pointer.resize(length);
+        }
+        for (const auto& item : target) {
+            if (source.find(item.first.view()) == source.end()) {
+                appendToken(pointer, item.first.view());
+                addOperation("add", &item.second);
+                pointer.resize(length);
+            }
+        }
+#else
+        // the members are sorted by key, so both objects are merged in one pass
+        auto first = source.begin();
+        auto second = target.begin();
+        while (first != source.end() || second != target.end()) {
+            int order = first == source.end() ? 1 : second == target.end() ? -1 : first->first.view().compare(second->first.view());
+            if (order < 0) {
+                appendToken(pointer, first->first.view());
+                addOperation("remove");
+                ++first;
+            } else if (order > 0) {
+                appendToken(pointer, second->first.view());
+                addOperation("add", &second->second);
+                ++second;
+            } else {
+                appendToken(pointer, first->first.view());
+                compare(first->second, second->second);
+                ++first;
+                ++second;
+            }
+            pointer.resize(length);
+        }
+#endif
+    }
+
+    /**
+     * Finds the shortest sequence of edits between two ranges with the greedy algorithm of Myers,
+     * which takes a time proportional to the size of the ranges times the number of edits.
+     * Returns false if there are more than maxArrayEdits edits.
+     */
+    bool findEdits(const Value* source, long sourceSize, const Value* target, long targetSize, std::vector<Edit>& edits) {
+
+        long maxEdits = (long)std::min<size_t>(sourceSize + targetSize, maxArrayEdits);
+        long offset = maxEdits + 1;
+
+        // furthest position in the source on each diagonal k = x - y, and a copy of the diagonals [-d - 1, d + 1]
+        // at the start of each step d to find the path back
+        std::vector<long> furthest(2 * maxEdits + 3, 0);
+        std::vector<std::vector<long>> trace;
+
+        for (long d = 0; d <= maxEdits; d++) {
+            trace.emplace_back(furthest.begin() + offset - d - 1, furthest.begin() + offset + d + 2);
+            for (long k = -d; k <= d; k += 2) {
+                bool down = k == -d || (k != d && furthest[offset + k - 1] < furthest[offset + k + 1]);
+                long x = down ? furthest[offset + k + 1] : furthest[offset + k - 1] + 1;
+                long y = x - k;
+                while (x < sourceSize && y < targetSize && same(source[x], target[y])) {
+                    x++;
+                    y++;
+                }
+                furthest[offset + k] = x;
+                if (x >= sourceSize && y >= targetSize) {
+                    backtrack(trace, sourceSize, targetSize, edits);
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    static void backtrack(const std::vector<std::vector<long>>& trace, long x, long y, std::vector<Edit>& edits) {
+        for (long d = (long)trace.size() - 1; d >= 0; d--) {
+            const std::vector<long>& furthest = trace[d];
+            long k = x - y;
+            bool down = k == -d || (k != d && furthest[k - 1 + d + 1] < furthest[k + 1 + d + 1]);
+            long previousK = down ? k + 1 : k - 1;
+            long previousX = furthest[previousK + d + 1];
+            long previousY = previousX - previousK;
+            while (x > previousX && y > previousY) {
+                edits.push_back(Edit::KEEP);
+                x--;
+                y--;
+            }
+            if (d > 0) {
+                edits.push_back(x == previousX ? Edit::INSERT : Edit::REMOVE);
+            }
+            x = previousX;
+            y = previousY;
+        }
+        std::reverse(edits.begin(), edits.end());
+    }
+
+    void compareArrays(const Array& source, const Array& target) {
+
+        size_t length = pointer.size();
+        auto atIndex = [&](size_t index) {
+            pointer.resize(length);
+            appendToken(pointer, std::to_string(index));
+        };
+
+        // the common prefix and suffix are skipped
+        size_t begin = 0;
+        size_t sourceEnd = source.size();
+        size_t targetEnd = target.size();
+        while (begin < sourceEnd && begin < targetEnd && same(source[begin], target[begin])) {
+            begin++;
+        }
+        while (sourceEnd > begin && targetEnd > begin && same(source[sourceEnd - 1], target[targetEnd - 1])) {
+            sourceEnd--;
+            targetEnd--;
+        }
+
+        std::vector<Edit> edits;
+        size_t x = begin;
+        size_t y = begin;
+
+        if (findEdits(source.data() + begin, sourceEnd - begin, target.data() + begin, targetEnd - begin, edits)) {
+            // a removal followed by an insertion is a modification of the element, which is compared in place
+            size_t index = begin;
+            for (size_t i = 0; i < edits.size();) {
+                if (edits[i] == Edit::KEEP) {
+                    index++;
+                    x++;
+                    y++;
+                    i++;
+                    continue;
+                }
+                size_t removed = 0;
+                size_t inserted = 0;
+                for (; i < edits.size() && edits[i] != Edit::KEEP; i++) {
+                    (edits[i] == Edit::REMOVE ? removed : inserted)++;
+                }
+                size_t modified = std::min(removed, inserted);
+                for (size_t j = 0; j < modified; j++) {
+                    atIndex(index++);
+                    compare(source[x++], target[y++]);
+                }
+                for (size_t j = modified; j < removed; j++) {
+                    atIndex(index);
+                    addOperation("remove");
+                    x++;
+                }
+                for (size_t j = modified; j < inserted; j++) {
+                    atIndex(index++);
+                    addOperation("add", &target[y++]);
+                }
+            }
+        } else {
+            // too many edits, the elements are compared by position
+            for (; x < sourceEnd && y < targetEnd; x++, y++) {
+                atIndex(x);
+                compare(source[x], target[y]);
+            }
+            // the removals start from the end so that the indices of the others do not change
+            for (size_t index = sourceEnd; index > x; index--) {
+                atIndex(index - 1);
+                addOperation("remove");
+            }
+            for (; y < targetEnd; y++) {
+                atIndex(y);
+                addOperation("add", &target[y]);
+            }
+        }
+
+        pointer.resize(length);
+    }
+
+public:
+
+    Differ(Array& operations, size_t maxArrayEdits) : operations(operations), maxArrayEdits(maxArrayEdits) {}
+
+    void compare(const Value& source, const Value& target) {
+        if (same(source, target)) {
+            return;
+        }
+        Type type = source.getType();
+        if (type != target.getType() || (type != Type::OBJECT && type != Type::ARRAY)) {
+            addOperation("replace", &target);
+        } else if (type == Type::OBJECT) {
+            compareObjects(source.getObjectValue(), target.getObjectValue());
+        } else {
+            Array sourceElements, targetElements;
+            compareArrays(getElements(source, sourceElements), getElements(target, targetElements));
+        }
+    }
+};
+
+/**
+ * Applies the operations of a patch one by one and records how to undo each of them.
+ * If an operation fails, the recorded operations are undone in reverse order.
+ */
+class Patcher {
+
+    struct Undo {
+
+        enum Kind {
+            ADD,
+            REMOVE,
+            REPLACE
+        };
+
+        Kind kind;
+        Pointer pointer;
+        Value value;
+    };
+
+    Value& root;
+    std::vector<Undo> undo;
+    size_t index = 0;
+
+    [[noreturn]] void fail(const std::string& reason) const {
+        throw PatchError(index, reason);
+    }
+
+    Pointer parse(const std::string& path) const {
+        Pointer pointer;
+        if (!parsePointer(path, pointer)) {
+            fail("invalid pointer '" + path + "'");
+        }
+        return pointer;
+    }
+
+    const Value& getMember(const Object& operation, const char* name) const {
+        auto it = operation.find(name);
+        if (it == operation.end()) {
+            fail(std::string("missing member '") + name + "'");
+        }
+        return it->second;
+    }
+
+    const std::string& getString(const Object& operation, const char* name) const {
+        const Value& value = getMember(operation, name);
+        if (!value.hasType(Type::STRING)) {
+            fail(std::string("member '") + name + "' is not a string");
+        }
+        return value.getStringValue();
+    }
+
+    /**
+     * Returns the value at the given path shared, or copied if it is an element of a packed array,
+     * which is read without building the values of the array (see Value::pack).
+     */
+    Value get(const std::string& path) const {
+        Pointer pointer = parse(path);
+        const Value* parent = pointer.empty() ? nullptr : findValue(static_cast<const Value&>(root), pointer, pointer.size() - 1);
+        if (parent != nullptr && parent->isPacked()) {
+            size_t index;
+            if (!parseIndex(pointer.back(), index) || index >= parent->getArraySize()) {
+                fail("'" + path + "' does not exist");
+            }
+            return parent->getElement(index);
+        }
+        const Value* value = findValue(static_cast<const Value&>(root), pointer, pointer.size());
+        if (value == nullptr) {
+            fail("'" + path + "' does not exist");
+        }
+        return value->share();
+    }
+
+    void add(const std::string& path, Value value) {
+
+        Pointer pointer = parse(path);
+        if (pointer.empty()) {
+            return replace(path, std::move(value));
+        }
+
+        Value* parent = findValue(root, pointer, pointer.size() - 1);
+        std::string& token = pointer.back();
+
+        if (parent != nullptr && parent->getType() == Type::OBJECT) {
+            Object& object = parent->getObjectValue();
+            auto it = object.find(token);
+            if (it != object.end()) {
+                undo.push_back({ Undo::REPLACE, std::move(pointer), std::move(it->second) });
+                it->second = std::move(value);
+            } else {
+                object[Key(token)] = std::move(value);
+                undo.push_back({ Undo::REMOVE, std::move(pointer), Value() });
+            }
+            return;
+        }
+
+        if (parent != nullptr && parent->getType() == Type::ARRAY) {
+            Array& array = parent->getArrayValue();
+            size_t index = array.size();
+            if (token != "-" && (!parseIndex(token, index) || index > array.size())) {
+                fail("'" + path + "' is out of bounds");
+            }
+            array.insert(array.begin() + index, std::move(value));
+            token = std::to_string(index);
+            undo.push_back({ Undo::REMOVE, std::move(pointer), Value() });
+            return;
+        }
+
+        fail("the parent of '" + path + "' does not exist");
+    }
+
+    Value remove(const std::string& path) {
+
+        Pointer pointer = parse(path);
+        if (pointer.empty()) {
+            fail("the root cannot be removed");
+        }
+
+        Value* parent = findValue(root, pointer, pointer.size() - 1);
+        const std::string& token = pointer.back();
+        Value removed;
+        size_t index;
+
+        if (parent != nullptr && parent->getType() == Type::OBJECT) {
+            Object& object = parent->getObjectValue();
+            auto it = object.find(token);
+            if (it == object.end()) {
+                fail("'" + path + "' does not exist");
+            }
+            removed = std::move(it->second);
+            object.erase(it);
+        } else if (parent != nullptr && parent->getType() == Type::ARRAY) {
+            Array& array = parent->getArrayValue();
+            if (!parseIndex(token, index) || index >= array.size()) {
+                fail("'" + path + "' does not exist");
+            }
+            removed = std::move(array[index]);
+            array.erase(array.begin() + index);
+        } else {
+            fail("'" + path + "' does not exist");
+        }
+
+        undo.push_back({ Undo::ADD, std::move(pointer), removed.share() });
+        return removed;
+    }
+
+    void replace(const std::string& path, Value value) {
+        Pointer pointer = parse(path);
+        Value* target = findValue(root, pointer, pointer.size());
+        if (target == nullptr) {
+            fail("'" + path + "' does not exist");
+        }
+        undo.push_back({ Undo::REPLACE, std::move(pointer), std::move(*target) });
+        *target = std::move(value);
+    }
+
+    void move(const std::string& from, const std::string& path) {
+        Pointer source = parse(from);
+        Pointer destination = parse(path);
+        if (source == destination) {
+            get(from);
+            return;
+        }
+        if (destination.size() > source.size() && std::equal(source.begin(), source.end(), destination.begin())) {
+            fail("'" + from + "' cannot be moved into itself");
+        }
+        add(path, remove(from));
+    }
+
+    void rollback() {
+        for (auto it = undo.rbegin(); it != undo.rend(); ++it) {
+            const Pointer& pointer = it->pointer;
+            if (it->kind == Undo::REPLACE) {
+                *findValue(root, pointer, pointer.size()) = std::move(it->value);
+                continue;
+            }
+            Value& parent = *findValue(root, pointer, pointer.size() - 1);
+            if (parent.getType() == Type::OBJECT) {
+                Object& object = parent.getObjectValue();
+                if (it->kind == Undo::ADD) {
+                    object[Key(pointer.back())] = std::move(it->value);
+                } else {
+                    object.erase(object.find(pointer.back()));
+                }
+            } else {
+                Array& array = parent.getArrayValue();
+                size_t index = 0;
+                parseIndex(pointer.back(), index);
+                if (it->kind == Undo::ADD) {
+                    array.insert(array.begin() + index, std::move(it->value));
+                } else {
+                    array.erase(array.begin() + index);
+                }
+            }
+        }
+        undo.clear();
+    }
+
+    void applyOperation(const Value& value) {
+
+        if (!value.hasType(Type::OBJECT)) {
+            fail("the operation is not an object");
+        }
+
+        const Object& operation = value.getObjectValue();
+        const std::string& op = getString(operation, "op");
+        const std::string& path = getString(operation, "path");
+
+        if (op == "add") {
+            add(path, getMember(operation, "value").share());
+        } else if (op == "remove") {
+            remove(path);
+        } else if (op == "replace") {
+            replace(path, getMember(operation, "value").share());
+        } else if (op == "move") {
+            move(getString(operation, "from"), path);
+        } else if (op == "copy") {
+            add(path, get(getString(operation, "from")));
+        } else if (op == "test") {
+            if (get(path) != getMember(operation, "value")) {
+                fail("'" + path + "' is not equal to the tested value");
+            }
+        } else {
+            fail("unknown operation '" + op + "'");
+        }
+    }
+
+public:
+
+    Patcher(Value& root) : root(root) {}
+
+    void run(const Value& patch) {
+        try {
+            if (!patch.hasType(Type::ARRAY)) {
+                fail("the patch is not an array");
+            }
+            for (const Value& operation : patch.getArrayValue()) {
+                applyOperation(operation);
+                index++;
+            }
+        } catch (...) {
+            rollback();
+            throw;
+        }
+    }
+};
+
+Value diff(const Value& source, const Value& target, size_t maxArrayEdits) {
+    Array operations;
+    Differ(operations, maxArrayEdits).compare(source, target);
+    return Value(std::move(operations));
+}
+
+void apply(Value& value, const Value& patch) {
+    Patcher(value).run(patch);
+}
+
+}
\ No newline at end of file
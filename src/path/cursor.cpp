@@ -13,12 +13,13 @@ size_t Path::Cursor::getDepth() const {
     return depth;
 }
 
-void Path::Cursor::next(const std::string& name) {
+template <class T>
+void Path::Cursor::nextStep(const T& step) {
     if (diff > 0) {
         diff++;
     } else if (cursor >= path.getSize()) {
         cursor++;
-    } else if (path[cursor].accept(name)) {
+    } else if (path[cursor].accept(step)) {
         matches[cursor]++;
         totalMatches++;
         cursor++;
@@ -31,22 +32,16 @@ void Path::Cursor::next(const std::string& name) {
     depth++;
 }
 
+void Path::Cursor::next(const std::string& name) {
+    nextStep(name);
+}
+
+void Path::Cursor::next(const Key& name) {
+    nextStep(name);
+}
+
 void Path::Cursor::next(size_t index) {
-    if (diff > 0) {
-        diff++;
-    } else if (cursor >= path.getSize()) {
-        cursor++;
-    } else if (path[cursor].accept(index)) {
-        matches[cursor]++;
-        totalMatches++;
-        cursor++;
-    } else if (path[cursor].deepScan) {
-        matches[cursor]++;
-        totalMatches++;
-    } else {
-        diff++;
-    }
-    depth++;
+    nextStep(index);
 }
 
 void Path::Cursor::prev() {
@@ -2,6 +2,9 @@
 
 namespace JSON {
 
+Path::Element::Name::Name(std::string name) :
+    std::string(std::move(name)) {}
+
 Path::Element::Index::Index(size_t index) :
     index(index) {}
 
@@ -13,6 +16,10 @@ bool Path::Element::accept(const std::string& name) const {
     return false;
 }
 
+bool Path::Element::accept(const Key& name) const {
+    return false;
+}
+
 bool Path::Element::accept(size_t index) const {
     return false;
 }
@@ -21,6 +28,10 @@ bool Path::Element::Name::accept(const std::string& name) const {
     return *this == name;
 }
 
+bool Path::Element::Name::accept(const Key& name) const {
+    return key == name;
+}
+
 bool Path::Element::Index::accept(size_t index) const {
     return this->index == index;
 }
@@ -33,6 +44,10 @@ bool Path::Element::Options::accept(const std::string& name) const {
     return first->accept(name) || second->accept(name);
 }
 
+bool Path::Element::Options::accept(const Key& name) const {
+    return first->accept(name) || second->accept(name);
+}
+
 bool Path::Element::Options::accept(size_t index) const {
     return first->accept(index) || second->accept(index);
 }
@@ -41,6 +56,10 @@ bool Path::Element::Any::accept(const std::string& name) const {
     return true;
 }
 
+bool Path::Element::Any::accept(const Key& name) const {
+    return true;
+}
+
 bool Path::Element::Any::accept(size_t index) const {
     return true;
 }
@@ -49,6 +68,10 @@ bool Path::Element::Function::accept(const std::string& name) const {
     return first(name);
 }
 
+bool Path::Element::Function::accept(const Key& name) const {
+    return first(name.str());
+}
+
 bool Path::Element::Function::accept(size_t index) const {
     return second(index);
 }
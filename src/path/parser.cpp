@@ -16,7 +16,7 @@ std::unique_ptr<Path::Element> Path::Parser::parseUnique() {
 
     if (lexer.token == Token::STRING) {
         lexer.getNextToken();
-        return std::unique_ptr<Path::Element::Name>(new Path::Element::Name(std::move((Path::Element::Name&)lexer.stringValue)));
+        return std::unique_ptr<Path::Element::Name>(new Path::Element::Name(std::move(lexer.stringValue)));
     }
 
     if (lexer.token == Token::NUMBER) {
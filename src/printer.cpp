@@ -1,5 +1,8 @@
 #include <json/printer.h>
 #include <cctype>
+#include <charconv>
+#include <cstring>
+#include <locale>
 
 namespace JSON {
 
@@ -77,6 +80,12 @@ void Printer::printChar(const unsigned char* str, int& i) {
 void Printer::printString(const char* str) {
     setColor("92");
     output << '\"';
+    printStringContent(str);
+    output << '\"';
+    setColor();
+}
+
+void Printer::printStringContent(const char* str) {
     for (int i = 0; str[i] != '\0'; i++) {
         switch (str[i]) {
             case '\"': output << "\\\""; break;
@@ -91,8 +100,6 @@ void Printer::printString(const char* str) {
                 break;
         }
     }
-    output << '\"';
-    setColor();
 }
 
 void Printer::startObject() {
@@ -126,11 +133,15 @@ void Printer::endArray() {
 }
 
 void Printer::key(const std::string& key) {
+    Printer::key(key.c_str());
+}
+
+void Printer::key(const char* key) {
     printComma();
     printTabs();
     colon = true;
     comma = false;
-    printString(key.c_str());
+    printString(key);
     output << ':';
 }
 
@@ -145,6 +156,27 @@ void Printer::value(const std::string& value) {
     Printer::value(value.c_str());
 }
 
+void Printer::startString() {
+    printComma();
+    printTabs();
+    comma = true;
+    setColor("92");
+    output << '\"';
+}
+
+void Printer::stringChunk(const char* chunk) {
+    printStringContent(chunk);
+}
+
+void Printer::stringChunk(const std::string& chunk) {
+    printStringContent(chunk.c_str());
+}
+
+void Printer::endString() {
+    output << '\"';
+    setColor();
+}
+
 void Printer::value(double value) {
     printComma();
     printTabs();
@@ -154,6 +186,26 @@ void Printer::value(double value) {
     setColor();
 }
 
+void Printer::value(int64_t value) {
+    char buffer[24];
+    printComma();
+    printTabs();
+    comma = true;
+    setColor("93");
+    output.write(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer);
+    setColor();
+}
+
+void Printer::value(uint64_t value) {
+    char buffer[24];
+    printComma();
+    printTabs();
+    comma = true;
+    setColor("93");
+    output.write(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer);
+    setColor();
+}
+
 void Printer::value(bool value) {
     printComma();
     printTabs();
@@ -172,4 +224,59 @@ void Printer::value() {
     setColor();
 }
 
+// formats the values in a buffer, F writes a value at the given position and returns its end
+template <class T, class F>
+void Printer::printValues(const T* values, size_t count, F format) {
+    if (indent > 0 || color) {
+        for (size_t index = 0; index < count; index++) {
+            value(values[index]);
+        }
+        return;
+    }
+    // a value takes less than 64 characters
+    char buffer[4096];
+    size_t size = 0;
+    for (size_t index = 0; index < count; index++) {
+        if (size > sizeof(buffer) - 64) {
+            output.write(buffer, size);
+            size = 0;
+        }
+        if (comma) {
+            buffer[size++] = ',';
+        }
+        comma = true;
+        size = format(buffer + size, buffer + sizeof(buffer), values[index]) - buffer;
+    }
+    output.write(buffer, size);
+}
+
+void Printer::values(const double* values, size_t count) {
+    // the stream prints doubles as printf("%.*g") with its precision, unless it has other flags or another locale
+    std::ios_base::fmtflags flags = std::ios_base::floatfield | std::ios_base::showpoint | std::ios_base::showpos | std::ios_base::uppercase;
+    int precision = (int)output.precision();
+    if ((output.flags() & flags) != 0 || precision < 0 || precision > 32 || output.getloc() != std::locale::classic()) {
+        for (size_t index = 0; index < count; index++) {
+            value(values[index]);
+        }
+        return;
+    }
+    printValues(values, count, [precision](char* begin, char* end, double value) {
+        return std::to_chars(begin, end, value, std::chars_format::general, precision).ptr;
+    });
+}
+
+void Printer::values(const int64_t* values, size_t count) {
+    printValues(values, count, [](char* begin, char* end, int64_t value) {
+        return std::to_chars(begin, end, value).ptr;
+    });
+}
+
+void Printer::values(const bool* values, size_t count) {
+    printValues(values, count, [](char* begin, char* end, bool value) {
+        size_t size = value ? 4 : 5;
+        memcpy(begin, value ? "true" : "false", size);
+        return begin + size;
+    });
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <json/reclaim.h>
+
+namespace JSON {
+
+static thread_local Reclaimer* currentReclaimer = nullptr;
+
+Reclaimer::Scope::Scope(Reclaimer& reclaimer) : previous(currentReclaimer) {
+    currentReclaimer = &reclaimer;
+}
+
+Reclaimer::Scope::~Scope() {
+    currentReclaimer = previous;
+}
+
+Reclaimer* Reclaimer::getCurrent() {
+    return currentReclaimer;
+}
+
+Reclaimer::Reclaimer(bool background, size_t minSize) : minSize(minSize), background(background) {
+    if (background) {
+        thread = std::thread(&Reclaimer::run, this);
+    }
+}
+
+Reclaimer::~Reclaimer() {
+    if (background) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        retired.notify_one();
+        thread.join();
+    } else {
+        reclaim();
+    }
+}
+
+void Reclaimer::retire(Value&& value) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(value));
+    }
+    if (background) {
+        retired.notify_one();
+    }
+}
+
+// the background thread stops once it is stopped and the queue is empty
+void Reclaimer::run() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            retired.wait(lock, [this] { return stopped || !pending.empty(); });
+            if (pending.empty()) {
+                return;
+            }
+        }
+        reclaim();
+    }
+}
+
+// each pending value is released without the lock, and its objects and arrays are queued in its place
+size_t Reclaimer::reclaim(size_t budget) {
+    size_t count = 0;
+    std::vector<Value> children;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (count < budget && !pending.empty()) {
+        Value value = std::move(pending.back());
+        pending.pop_back();
+        busy++;
+        lock.unlock();
+        count += value.release(children);
+        lock.lock();
+        busy--;
+        for (Value& child : children) {
+            pending.push_back(std::move(child));
+        }
+        children.clear();
+    }
+    if (pending.empty() && busy == 0) {
+        idle.notify_all();
+    }
+    return count;
+}
+
+void Reclaimer::wait() {
+    if (!background) {
+        reclaim();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return pending.empty() && busy == 0; });
+}
+
+size_t Reclaimer::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size() + busy;
+}
+
+size_t Reclaimer::getMinSize() const {
+    return minSize;
+}
+
+}
\ No newline at end of file
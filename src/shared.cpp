@@ -0,0 +1,121 @@
+#include <json/shared.h>
+#include <thread>
+#include <functional>
+
+namespace JSON {
+
+// the slot used last by the thread, so that the threads spread over the slots and usually find theirs free
+static thread_local size_t slotHint = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+SharedValue::Snapshot::Snapshot(const Value* value, Slot* slot) : value(value), slot(slot) {}
+
+SharedValue::Snapshot::Snapshot(Value&& copy) : value(&this->copy), slot(nullptr), copy(std::move(copy)) {}
+
+// a snapshot that holds a copy points to its own copy
+SharedValue::Snapshot::Snapshot(Snapshot&& snapshot) noexcept :
+    value(snapshot.value == &snapshot.copy ? &copy : snapshot.value), slot(snapshot.slot), copy(std::move(snapshot.copy)) {
+    snapshot.slot = nullptr;
+}
+
+SharedValue::Snapshot& SharedValue::Snapshot::operator=(Snapshot&& snapshot) noexcept {
+    if (this != &snapshot) {
+        if (slot != nullptr) {
+            slot->epoch.store(0, std::memory_order_release);
+        }
+        value = snapshot.value == &snapshot.copy ? &copy : snapshot.value;
+        slot = snapshot.slot;
+        copy = std::move(snapshot.copy);
+        snapshot.slot = nullptr;
+    }
+    return *this;
+}
+
+SharedValue::Snapshot::~Snapshot() {
+    if (slot != nullptr) {
+        slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+SharedValue::SharedValue(Value value, size_t slotCount) :
+    current(new Value(value.share())), slots(new Slot[slotCount > 0 ? slotCount : 1]), slotCount(slotCount > 0 ? slotCount : 1) {}
+
+SharedValue::~SharedValue() {
+    for (const Retired& value : retired) {
+        delete value.value;
+    }
+    delete current.load(std::memory_order_relaxed);
+}
+
+// returns nullptr if all the slots are used, the reader does not wait since it may hold one of them
+SharedValue::Slot* SharedValue::acquireSlot() const {
+    for (size_t i = 0; i < slotCount; i++) {
+        Slot& slot = slots[(slotHint + i) % slotCount];
+        uint64_t free = 0;
+        if (slot.epoch.load(std::memory_order_relaxed) == 0 &&
+            slot.epoch.compare_exchange_strong(free, epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst)) {
+            slotHint = (slotHint + i) % slotCount;
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+// the epoch of the slot is written before the value is read, so a writer that replaces the value
+// after it was read sees the slot and does not destroy the value
+SharedValue::Snapshot SharedValue::read() const {
+    Slot* slot = acquireSlot();
+    if (slot == nullptr) {
+        // the writers do not replace the value while their mutex is held, and the copy shares its content
+        std::lock_guard<std::mutex> lock(writer);
+        return Snapshot(Value(*current.load(std::memory_order_acquire)));
+    }
+    return Snapshot(current.load(std::memory_order_seq_cst), slot);
+}
+
+Value SharedValue::load() const {
+    return *read();
+}
+
+void SharedValue::store(Value value) {
+    std::lock_guard<std::mutex> lock(writer);
+    publish(std::move(value));
+}
+
+// the replaced value is retired with the new epoch, the readers that started before it may still hold it
+void SharedValue::publish(Value&& value) {
+    const Value* published = new Value(value.share());
+    const Value* replaced = current.exchange(published, std::memory_order_seq_cst);
+    uint64_t replacedEpoch = epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+    retired.push_back({ replaced, replacedEpoch });
+    reclaim();
+}
+
+// a retired value is destroyed when all the readers started in its epoch or after
+void SharedValue::reclaim() {
+
+    uint64_t oldest = UINT64_MAX;
+    for (size_t i = 0; i < slotCount; i++) {
+        uint64_t slotEpoch = slots[i].epoch.load(std::memory_order_seq_cst);
+        if (slotEpoch != 0 && slotEpoch < oldest) {
+            oldest = slotEpoch;
+        }
+    }
+
+    size_t kept = 0;
+    for (const Retired& value : retired) {
+        if (value.epoch <= oldest) {
+            delete value.value;
+        } else {
+            retired[kept++] = value;
+        }
+    }
+    retired.resize(kept);
+}
+
+size_t SharedValue::getRetiredCount() {
+    std::lock_guard<std::mutex> lock(writer);
+    reclaim();
+    return retired.size();
+}
+
+}
\ No newline at end of file
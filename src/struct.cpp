@@ -54,8 +54,9 @@ class StructParser : public Parser {
         void* subBase = getField(base);
         StructFieldInfos subFieldInfos(subStruct.getFields());
         StructParser subParser(subBase, subFieldInfos);
-        Parser::delegate(subParser);
-        subFieldInfos.setDefaults(subBase);
+        if (Parser::delegate(subParser)) {
+            subFieldInfos.setDefaults(subBase);
+        }
     }
 
     void trySetStruct() {
@@ -99,7 +100,20 @@ public:
     }
 
     void onNumber(double value) override {
-        trySetPrimitive(Type::NUMBER, &value);
+        Struct::NumberValue number{ value, NumberType::DOUBLE, 0, 0 };
+        trySetPrimitive(Type::NUMBER, &number);
+        prev();
+    }
+
+    void onInteger(int64_t value) override {
+        Struct::NumberValue number{ (double)value, NumberType::INT64, value, 0 };
+        trySetPrimitive(Type::NUMBER, &number);
+        prev();
+    }
+
+    void onUnsigned(uint64_t value) override {
+        Struct::NumberValue number{ (double)value, NumberType::UINT64, 0, value };
+        trySetPrimitive(Type::NUMBER, &number);
         prev();
     }
 
@@ -144,6 +158,30 @@ void Struct::parse(void* base, std::istream& input, const Path& path) {
     fieldInfos.setDefaults(base);
 }
 
+void Struct::parse(void* base, const Tape& tape, const Path& path) {
+    StructFieldInfos fieldInfos(fields);
+    StructParser structParser(base, fieldInfos);
+    structParser.parse(tape, path);
+    fieldInfos.setDefaults(base);
+}
+
+void Struct::parse(void* base, std::istream& input, Format format, const Path& path) {
+    StructFieldInfos fieldInfos(fields);
+    StructParser structParser(base, fieldInfos);
+    structParser.parse(input, format, path);
+    fieldInfos.setDefaults(base);
+}
+
+Status Struct::tryParse(void* base, std::istream& input, const Path& path) {
+    StructFieldInfos fieldInfos(fields);
+    StructParser structParser(base, fieldInfos);
+    Status status = structParser.tryParse(input, path);
+    if (status.ok()) {
+        fieldInfos.setDefaults(base);
+    }
+    return status;
+}
+
 static bool setCharPrimitive(void* field, int count, Type type, void* value) {
     if (type == Type::STRING) {
         std::string& stringValue = *(std::string*)value;
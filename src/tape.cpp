@@ -0,0 +1,261 @@
+#include <json/tape.h>
+#include <json/parser.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace JSON {
+
+static const char tapeMagic[8] = { 'J', 'S', 'O', 'N', 'T', 'A', 'P', 'E' };
+static const uint64_t tapeVersion = 2;
+
+/**
+ * Returns the number of bytes left in a seekable stream, or UINT64_MAX if the stream cannot be sought.
+ */
+static uint64_t getRemainingSize(std::istream& input) {
+    std::streampos position = input.tellg();
+    if (position == std::streampos(-1) || !input.seekg(0, std::ios::end)) {
+        input.clear();
+        return UINT64_MAX;
+    }
+    std::streampos end = input.tellg();
+    input.seekg(position);
+    return end == std::streampos(-1) || end < position ? UINT64_MAX : (uint64_t)(end - position);
+}
+
+/**
+ * Reads the given number of elements, growing the container as they are read, so that a corrupted count
+ * read from a stream that cannot be sought fails at the end of the stream instead of being allocated at once.
+ */
+template <class C>
+static bool readElements(std::istream& input, C& elements, uint64_t count) {
+    static const uint64_t chunkSize = (1 << 20) / sizeof(typename C::value_type);
+    while (elements.size() < count) {
+        size_t size = elements.size();
+        size_t chunk = (size_t)std::min(chunkSize, count - size);
+        if (elements.capacity() < size + chunk) {
+            elements.reserve((size_t)std::min<uint64_t>(count, std::max(size * 2, size + chunk)));
+        }
+        elements.resize(size + chunk);
+        if (!input.read((char*)&elements[size], chunk * sizeof(typename C::value_type))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class RecordParser : public Parser {
+    void onObjectStart() override {}
+    void onObjectEnd() override {}
+    void onArrayStart() override {}
+    void onArrayEnd() override {}
+    void onKey(std::string& key) override {}
+    void onIndex(size_t index) override {}
+    void onNumber(double value) override {}
+    void onBoolean(bool value) override {}
+    void onString(std::string& value) override {}
+    void onNull() override {}
+
+public:
+
+    RecordParser(Tape& tape) {
+        setRecorder(&tape);
+    }
+};
+
+Tape::Tape(std::istream& input) {
+    record(input);
+}
+
+void Tape::record(std::istream& input) {
+    Status status = tryRecord(input);
+    if (!status.ok()) {
+        Parser::throwError(status);
+    }
+}
+
+Status Tape::tryRecord(std::istream& input) {
+    clear();
+    Status status = RecordParser(*this).tryParse(input);
+    if (!status.ok()) {
+        clear();
+    }
+    return status;
+}
+
+void Tape::clear() {
+    tokens.clear();
+    data.clear();
+}
+
+void Tape::append(Token token, uint64_t payload) {
+    tokens.push_back((payload << 8) | (uint64_t)token);
+}
+
+uint64_t Tape::getPayload(size_t index) const {
+    return tokens[index] >> 8;
+}
+
+void Tape::appendToken(Token token) {
+    append(token);
+}
+
+// a number is stored as its representation followed by 8 bytes of value
+void Tape::appendNumber(double value) {
+    append(Token::NUMBER, data.size());
+    data.push_back((char)NumberType::DOUBLE);
+    data.append((const char*)&value, sizeof(value));
+}
+
+void Tape::appendInteger(int64_t value) {
+    append(Token::NUMBER, data.size());
+    data.push_back((char)NumberType::INT64);
+    data.append((const char*)&value, sizeof(value));
+}
+
+void Tape::appendUnsigned(uint64_t value) {
+    append(Token::NUMBER, data.size());
+    data.push_back((char)NumberType::UINT64);
+    data.append((const char*)&value, sizeof(value));
+}
+
+void Tape::appendString(std::string_view value) {
+    uint64_t size = value.size();
+    append(Token::STRING, data.size());
+    data.append((const char*)&size, sizeof(size));
+    data.append(value);
+}
+
+void Tape::appendStringChunk(std::string_view chunk) {
+    uint64_t size;
+    char* sizePointer = &data[getPayload(tokens.size() - 1)];
+    memcpy(&size, sizePointer, sizeof(size));
+    size += chunk.size();
+    memcpy(sizePointer, &size, sizeof(size));
+    data.append(chunk);
+}
+
+void Tape::appendBoolean(bool value) {
+    append(Token::BOOLEAN, value);
+}
+
+size_t Tape::getSize() const {
+    return tokens.size();
+}
+
+Token Tape::getToken(size_t index) const {
+    return (Token)(tokens[index] & 0xFF);
+}
+
+NumberType Tape::getNumberType(size_t index) const {
+    return (NumberType)data[getPayload(index)];
+}
+
+double Tape::getNumberValue(size_t index) const {
+    switch (getNumberType(index)) {
+        case NumberType::INT64: return getIntegerValue(index);
+        case NumberType::UINT64: return getUnsignedValue(index);
+        default: break;
+    }
+    double value;
+    memcpy(&value, &data[getPayload(index) + 1], sizeof(value));
+    return value;
+}
+
+int64_t Tape::getIntegerValue(size_t index) const {
+    int64_t value = 0;
+    if (getNumberType(index) == NumberType::INT64) {
+        memcpy(&value, &data[getPayload(index) + 1], sizeof(value));
+    }
+    return value;
+}
+
+uint64_t Tape::getUnsignedValue(size_t index) const {
+    uint64_t value = 0;
+    if (getNumberType(index) == NumberType::UINT64) {
+        memcpy(&value, &data[getPayload(index) + 1], sizeof(value));
+    }
+    return value;
+}
+
+std::string_view Tape::getStringValue(size_t index) const {
+    uint64_t size;
+    const char* sizePointer = &data[getPayload(index)];
+    memcpy(&size, sizePointer, sizeof(size));
+    return std::string_view(sizePointer + sizeof(size), size);
+}
+
+bool Tape::getBooleanValue(size_t index) const {
+    return getPayload(index) != 0;
+}
+
+void Tape::save(std::ostream& output) const {
+    uint64_t header[3] = { tapeVersion, tokens.size(), data.size() };
+    output.write(tapeMagic, sizeof(tapeMagic));
+    output.write((const char*)header, sizeof(header));
+    output.write((const char*)tokens.data(), tokens.size() * sizeof(uint64_t));
+    output.write(data.data(), data.size());
+}
+
+void Tape::load(std::istream& input) {
+
+    char magic[sizeof(tapeMagic)];
+    uint64_t header[3];
+
+    if (!input.read(magic, sizeof(magic)) || memcmp(magic, tapeMagic, sizeof(magic)) != 0 ||
+        !input.read((char*)header, sizeof(header)) || header[0] != tapeVersion) {
+        throw std::runtime_error("Invalid tape header");
+    }
+
+    // the sizes are checked against the rest of the stream before anything is allocated
+    if (header[1] > (UINT64_MAX - header[2]) / sizeof(uint64_t) ||
+        header[1] * sizeof(uint64_t) + header[2] > getRemainingSize(input)) {
+        throw std::runtime_error("Invalid tape header");
+    }
+
+    std::vector<uint64_t> tokens;
+    std::string data;
+
+    if (!readElements(input, tokens, header[1]) || !readElements(input, data, header[2])) {
+        throw std::runtime_error("Unexpected end of tape");
+    }
+
+    // check the offsets so that a corrupted tape cannot be read out of bounds
+    for (uint64_t token : tokens) {
+        uint64_t payload = token >> 8;
+        uint64_t size;
+        switch ((Token)(token & 0xFF)) {
+            case Token::NUMBER:
+                if (payload > data.size() || data.size() - payload < 1 + sizeof(double) ||
+                    (unsigned char)data[payload] > (unsigned char)NumberType::UINT64) {
+                    throw std::runtime_error("Invalid number in tape");
+                }
+                break;
+            case Token::STRING:
+                if (payload > data.size() || data.size() - payload < sizeof(size)) {
+                    throw std::runtime_error("Invalid string in tape");
+                }
+                memcpy(&size, &data[payload], sizeof(size));
+                if (data.size() - payload - sizeof(size) < size) {
+                    throw std::runtime_error("Invalid string in tape");
+                }
+                break;
+            case Token::OBJECT_START:
+            case Token::OBJECT_END:
+            case Token::ARRAY_START:
+            case Token::ARRAY_END:
+            case Token::COLON:
+            case Token::COMMA:
+            case Token::BOOLEAN:
+            case Token::NULL_:
+                break;
+            default:
+                throw std::runtime_error("Invalid token in tape");
+        }
+    }
+
+    this->tokens = std::move(tokens);
+    this->data = std::move(data);
+}
+
+}
\ No newline at end of file
@@ -1,12 +1,14 @@
 #include <json/utils.h>
 #include <json/parser.h>
 #include <json/printer.h>
+#include <json/binary.h>
 
 namespace JSON {
 
+template <class P>
 class CopyParser : public JSON::Parser {
 
-    JSON::Printer printer;
+    P printer;
 
     void onObjectStart() override {
         printer.startObject();
@@ -36,6 +38,14 @@ class CopyParser : public JSON::Parser {
         printer.value(value);
     }
 
+    void onInteger(int64_t value) override {
+        printer.value(value);
+    }
+
+    void onUnsigned(uint64_t value) override {
+        printer.value(value);
+    }
+
     void onBoolean(bool value) override {
         printer.value(value);
     }
@@ -48,14 +58,41 @@ class CopyParser : public JSON::Parser {
         printer.value();
     }
 
+    void onStringStart() override {
+        printer.startString();
+    }
+
+    void onStringChunk(std::string& chunk) override {
+        printer.stringChunk(chunk);
+    }
+
+    void onStringEnd() override {
+        printer.endString();
+    }
+
 public:
 
-    CopyParser(std::ostream& output, int ident, bool escapeUnicode) :
-        printer(output, ident, escapeUnicode) {}
+    template <class... Args>
+    CopyParser(std::ostream& output, Args... args) :
+        printer(output, args...) {
+        setStringChunkSize(1 << 16);
+    }
 };
 
 void copy(std::ostream& output, std::istream& input, int indent, bool escapeUnicode, const Path& path) {
-    CopyParser(output, indent, escapeUnicode).parse(input, path);
+    CopyParser<Printer>(output, indent, escapeUnicode).parse(input, path);
+}
+
+void copy(std::ostream& output, const Tape& tape, int indent, bool escapeUnicode, const Path& path) {
+    CopyParser<Printer>(output, indent, escapeUnicode).parse(tape, path);
+}
+
+void transcode(std::ostream& output, Format outputFormat, std::istream& input, Format inputFormat, const Path& path) {
+    if (outputFormat == Format::TEXT) {
+        CopyParser<Printer>(output, 0, true).parse(input, inputFormat, path);
+    } else {
+        CopyParser<BinaryPrinter>(output, outputFormat).parse(input, inputFormat, path);
+    }
 }
 
 class ValidateParser : public JSON::Parser {
@@ -72,12 +109,7 @@ class ValidateParser : public JSON::Parser {
 };
 
 bool check(std::istream& input) {
-    try {
-        ValidateParser().parse(input);
-        return true;
-    } catch (const JSON::Error&) {
-        return false;
-    }
+    return ValidateParser().tryParse(input).ok();
 }
 
 }
\ No newline at end of file
@@ -1,7 +1,15 @@
 #include <json/value.h>
 #include <json/parser.h>
+#include <json/lexer.h>
+#include <json/hints.h>
+#include <json/reclaim.h>
 #include <sstream>
 #include <fstream>
+#include <cmath>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+#include <unordered_set>
 
 namespace JSON {
 
@@ -21,118 +29,678 @@ Value::UndefinedValueError::UndefinedValueError() {
     message = "value is undefined";
 }
 
+Value::NumberConversionError::NumberConversionError(NumberType type) : type(type) {
+    switch (type) {
+        case NumberType::INT64: message = "number is not a 64-bit integer"; break;
+        case NumberType::UINT64: message = "number is not an unsigned 64-bit integer"; break;
+        default: message = "number is not stored as a double"; break;
+    }
+}
+
+static bool toInteger(double value, Integer& integer) {
+    if (value >= -0x1p63 && value < 0x1p63 && value == std::trunc(value)) {
+        integer = (Integer)value;
+        return true;
+    }
+    return false;
+}
+
+static bool toUnsigned(double value, Unsigned& integer) {
+    if (value >= 0 && value < 0x1p64 && value == std::trunc(value)) {
+        integer = (Unsigned)value;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * The content of a string, an object or an array, allocated out of line so that a value fits in 16 bytes.
+ * The block remembers the memory resource it was allocated with (see Arena).
+ * A shared block is referenced by all the copies of a value instead of being copied (see Value::share).
+ * The hash of the content is cached in the block while it cannot be modified in place, 0 meaning that it is not
+ * computed (see Value::hash).
+ */
+template <class T>
+struct Value::Block {
+
+    std::atomic<uint32_t> references;
+    std::atomic<bool> shared;
+    std::atomic<size_t> hash;
+    std::pmr::memory_resource* resource;
+    T value;
+
+    template <class... Args>
+    Block(std::pmr::memory_resource* resource, Args&&... args) :
+        references(1), shared(false), hash(0), resource(resource), value(std::forward<Args>(args)...) {}
+};
+
+/**
+ * The text of an object or an array that is not parsed yet.
+ * The whole document is shared by all its lazy values.
+ */
+struct Value::Lazy {
+    std::shared_ptr<const std::string> source;
+    size_t begin;
+    size_t size;
+};
+
+/**
+ * The elements of a packed array, stored contiguously without their type.
+ * The elements are never modified, the array is unpacked instead. The array of values read through the
+ * const getters, only kept for compatibility, is built by the first reader and kept, the other readers use the same one.
+ */
+struct Value::Packed {
+
+    Type type;
+    NumberType numberType;
+    size_t size;
+    std::pmr::memory_resource* resource;
+    void* data;
+    mutable std::atomic<Array*> unpacked{ nullptr };
+
+    Packed(Type type, NumberType numberType, size_t size) :
+        type(type), numberType(numberType), size(size), resource(Arena::getCurrent()),
+        data(resource->allocate(getDataSize(), alignof(Number))) {}
+
+    Packed(const Packed& packed) : Packed(packed.type, packed.numberType, packed.size) {
+        memcpy(data, packed.data, getDataSize());
+    }
+
+    ~Packed() {
+        delete unpacked.load(std::memory_order_acquire);
+        resource->deallocate(data, getDataSize(), alignof(Number));
+    }
+
+    size_t getDataSize() const {
+        return size * (type == Type::BOOLEAN ? sizeof(Boolean) : sizeof(Number));
+    }
+
+    template <class T>
+    T* get() const {
+        return static_cast<T*>(data);
+    }
+
+    // calls the function with each element, as a Number, an Integer or a Boolean
+    template <class F>
+    void forEach(F function) const {
+        if (type == Type::BOOLEAN) {
+            std::for_each(get<Boolean>(), get<Boolean>() + size, function);
+        } else if (numberType == NumberType::INT64) {
+            std::for_each(get<Integer>(), get<Integer>() + size, function);
+        } else {
+            std::for_each(get<Number>(), get<Number>() + size, function);
+        }
+    }
+
+    bool hasSameType(const Packed& packed) const {
+        return type == packed.type && (type == Type::BOOLEAN || numberType == packed.numberType);
+    }
+
+    const Array& getArray() const {
+        Array* array = unpacked.load(std::memory_order_acquire);
+        if (array != nullptr) {
+            return *array;
+        }
+        Array* created = new Array(Allocator<Value>(resource));
+        created->reserve(size);
+        forEach([&](auto element) { created->emplace_back(element); });
+        if (unpacked.compare_exchange_strong(array, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return *created;
+        }
+        // another reader built it first
+        delete created;
+        return *array;
+    }
+
+    Value getElement(size_t index) const {
+        if (type == Type::BOOLEAN) {
+            return get<Boolean>()[index];
+        }
+        if (numberType == NumberType::INT64) {
+            return get<Integer>()[index];
+        }
+        return get<Number>()[index];
+    }
+
+    // only called for elements of the same type
+    bool operator==(const Packed& packed) const {
+        if (size != packed.size) {
+            return false;
+        }
+        if (type == Type::BOOLEAN || numberType == NumberType::INT64) {
+            return memcmp(data, packed.data, getDataSize()) == 0;
+        }
+        // the doubles are compared in blocks without branches so that the comparisons are vectorized,
+        // they cannot be compared as bytes since 0.0 == -0.0 and NaN != NaN
+        static const size_t blockSize = 256;
+        const Number* first = get<Number>();
+        const Number* second = packed.get<Number>();
+        for (size_t begin = 0; begin < size; begin += blockSize) {
+            size_t end = std::min(size, begin + blockSize);
+            bool equal = true;
+            for (size_t index = begin; index < end; index++) {
+                equal &= first[index] == second[index];
+            }
+            if (!equal) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * A read-only stream buffer over a part of a string, so that it can be lexed without being copied.
+ */
+class SpanBuffer : public std::streambuf {
+
+public:
+
+    SpanBuffer(const char* data, size_t size) {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+};
+
+static_assert(sizeof(Value) <= 16, "a value must fit in 16 bytes");
+
+template <class T, class... Args>
+Value::Block<T>* Value::createBlock(Args&&... args) {
+    std::pmr::memory_resource* resource = Arena::getCurrent();
+    void* memory = resource->allocate(sizeof(Block<T>), alignof(Block<T>));
+    try {
+        return new (memory) Block<T>(resource, std::forward<Args>(args)...);
+    } catch (...) {
+        resource->deallocate(memory, sizeof(Block<T>), alignof(Block<T>));
+        throw;
+    }
+}
+
+template <class T>
+Value::Block<T>* Value::copyBlock(Block<T>* block) {
+    if (block->shared.load(std::memory_order_relaxed)) {
+        block->references.fetch_add(1, std::memory_order_relaxed);
+        return block;
+    }
+    return createBlock<T>(block->value);
+}
+
+template <class T>
+void Value::destroyBlock(Block<T>* block) {
+    if (block->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    std::pmr::memory_resource* resource = block->resource;
+    block->~Block();
+    resource->deallocate(block, sizeof(Block<T>), alignof(Block<T>));
+}
+
+template <class T>
+bool Value::isUnique(const Block<T>* block) {
+    return block->references.load(std::memory_order_acquire) == 1;
+}
+
+// a block referenced by several values is copied before being modified, and a packed block is never modified,
+// but a unique block can be modified through references to its content or to its children at any time
+template <class T>
+bool Value::isImmutable(const Block<T>* block) {
+    return block->references.load(std::memory_order_acquire) > 1;
+}
+
+template <>
+bool Value::isImmutable(const Block<Packed>*) {
+    return true;
+}
+
+template <class T, class F>
+size_t Value::getCachedHash(Block<T>* block, F compute) {
+    if (!isImmutable(block)) {
+        return compute(block->value);
+    }
+    // a shared block can be hashed by different threads at the same time, they store the same hash
+    size_t hash = block->hash.load(std::memory_order_relaxed);
+    if (hash == 0) {
+        hash = compute(block->value);
+        if (hash == 0) {
+            hash = 1;
+        }
+        block->hash.store(hash, std::memory_order_relaxed);
+    }
+    return hash;
+}
+
+template <class T>
+bool Value::equalBlocks(const Block<T>* first, const Block<T>* second) {
+    if (first == second) {
+        return true;
+    }
+    if (isImmutable(first) && isImmutable(second)) {
+        size_t firstHash = first->hash.load(std::memory_order_relaxed);
+        size_t secondHash = second->hash.load(std::memory_order_relaxed);
+        if (firstHash != 0 && secondHash != 0 && firstHash != secondHash) {
+            return false;
+        }
+    }
+    return first->value == second->value;
+}
+
+void Value::resetHash() {
+    // the content of lazy and packed values is not modified
+    if (lazy || packed) {
+        return;
+    }
+    switch (type) {
+        case Type::STRING: stringBlock->hash.store(0, std::memory_order_relaxed); break;
+        case Type::OBJECT: objectBlock->hash.store(0, std::memory_order_relaxed); break;
+        case Type::ARRAY: arrayBlock->hash.store(0, std::memory_order_relaxed); break;
+    }
+}
+
+void Value::markShared() const {
+    if (lazy) {
+        // a lazy block is copied, not shared, its content is immutable anyway
+        return;
+    }
+    if (packed) {
+        packedBlock->shared.store(true, std::memory_order_relaxed);
+        return;
+    }
+    switch (type) {
+        case Type::STRING: stringBlock->shared.store(true, std::memory_order_relaxed); break;
+        case Type::OBJECT: objectBlock->shared.store(true, std::memory_order_relaxed); break;
+        case Type::ARRAY: arrayBlock->shared.store(true, std::memory_order_relaxed); break;
+    }
+}
+
+void Value::detach() {
+    materialize();
+    if (packed) {
+        unpack();
+    }
+    switch (type) {
+        case Type::STRING:
+            if (!isUnique(stringBlock)) {
+                Block<String>* block = createBlock<String>(stringBlock->value);
+                destroyBlock(stringBlock);
+                stringBlock = block;
+            }
+            break;
+        case Type::OBJECT:
+            if (!isUnique(objectBlock)) {
+                // the children are shared by the copy, only this level is copied
+                for (const auto& item : objectBlock->value) {
+                    item.second.markShared();
+                }
+                Block<Object>* block = createBlock<Object>(objectBlock->value);
+                destroyBlock(objectBlock);
+                objectBlock = block;
+            }
+            break;
+        case Type::ARRAY:
+            if (!isUnique(arrayBlock)) {
+                for (const Value& value : arrayBlock->value) {
+                    value.markShared();
+                }
+                Block<Array>* block = createBlock<Array>(arrayBlock->value);
+                destroyBlock(arrayBlock);
+                arrayBlock = block;
+            }
+            break;
+    }
+    // the content can be modified through the returned references
+    resetHash();
+}
+
+// a large unique object or array is handed to the reclaimer of the thread instead of being destroyed
+bool Value::retire() {
+    Reclaimer* reclaimer = Reclaimer::getCurrent();
+    if (reclaimer == nullptr || lazy || packed) {
+        return false;
+    }
+    bool large;
+    switch (type) {
+        case Type::OBJECT:
+            large = isUnique(objectBlock) && objectBlock->resource == std::pmr::new_delete_resource() &&
+                objectBlock->value.size() >= reclaimer->getMinSize();
+            break;
+        case Type::ARRAY:
+            large = isUnique(arrayBlock) && arrayBlock->resource == std::pmr::new_delete_resource() &&
+                arrayBlock->value.size() >= reclaimer->getMinSize();
+            break;
+        default:
+            return false;
+    }
+    if (!large) {
+        return false;
+    }
+    Value value;
+    value.assignValue(std::move(*this));
+    reclaimer->retire(std::move(value));
+    return true;
+}
+
+// moves the objects and arrays of a unique value to children, so that destroying it does not recurse
+size_t Value::release(std::vector<Value>& children) {
+    size_t count = 1;
+    if (!lazy && !packed) {
+        if (type == Type::OBJECT && isUnique(objectBlock)) {
+            for (auto& member : objectBlock->value) {
+                Value& child = member.second;
+                if (!child.lazy && !child.packed && (child.type == Type::OBJECT || child.type == Type::ARRAY)) {
+                    children.push_back(std::move(child));
+                }
+            }
+            count += objectBlock->value.size();
+        } else if (type == Type::ARRAY && isUnique(arrayBlock)) {
+            for (Value& child : arrayBlock->value) {
+                if (!child.lazy && !child.packed && (child.type == Type::OBJECT || child.type == Type::ARRAY)) {
+                    children.push_back(std::move(child));
+                }
+            }
+            count += arrayBlock->value.size();
+        }
+    }
+    destroyValue();
+    type = Type::UNDEFINED;
+    return count;
+}
+
 void Value::clearValue() {
+    if ((type == Type::OBJECT || type == Type::ARRAY) && retire()) {
+        return;
+    }
+    destroyValue();
+}
+
+void Value::destroyValue() {
+    if (lazy) {
+        destroyBlock(lazyBlock);
+        lazy = false;
+        return;
+    }
+    if (packed) {
+        destroyBlock(packedBlock);
+        packed = false;
+        return;
+    }
     switch (type) {
-        case Type::STRING: stringValue.~String(); break;
-        case Type::OBJECT: objectValue.~Object(); break;
-        case Type::ARRAY: arrayValue.~Array(); break;
+        case Type::STRING: destroyBlock(stringBlock); break;
+        case Type::OBJECT: destroyBlock(objectBlock); break;
+        case Type::ARRAY: destroyBlock(arrayBlock); break;
+    }
+}
+
+void Value::assignNumber(const Value& value) {
+    switch (numberType = value.numberType) {
+        case NumberType::INT64: integerValue = value.integerValue; break;
+        case NumberType::UINT64: unsignedValue = value.unsignedValue; break;
+        default: numberValue = value.numberValue; break;
     }
 }
 
 void Value::assignValue(const Value& value) {
-    switch (type = value.type) {
-        case Type::NUMBER: numberValue = value.numberValue; break;
+    if (value.lazy) {
+        lazyBlock = copyBlock(value.lazyBlock);
+        lazy = true;
+        type = value.type;
+        return;
+    }
+    if (value.packed) {
+        packedBlock = copyBlock(value.packedBlock);
+        packed = true;
+        type = value.type;
+        return;
+    }
+    switch (value.type) {
+        case Type::NUMBER: assignNumber(value); break;
         case Type::BOOLEAN: booleanValue = value.booleanValue; break;
         case Type::NULL_: nullValue = value.nullValue; break;
-        case Type::STRING: new (&stringValue) String(value.stringValue); break;
-        case Type::OBJECT: new (&objectValue) Object(value.objectValue); break;
-        case Type::ARRAY: new (&arrayValue) Array(value.arrayValue); break;
+        case Type::STRING: stringBlock = copyBlock(value.stringBlock); break;
+        case Type::OBJECT: objectBlock = copyBlock(value.objectBlock); break;
+        case Type::ARRAY: arrayBlock = copyBlock(value.arrayBlock); break;
     }
+    type = value.type;
 }
 
 void Value::assignValue(Value&& value) {
+    if (value.lazy) {
+        lazyBlock = value.lazyBlock;
+        lazy = true;
+        type = value.type;
+        value.lazy = false;
+        value.type = Type::UNDEFINED;
+        return;
+    }
+    if (value.packed) {
+        packedBlock = value.packedBlock;
+        packed = true;
+        type = value.type;
+        value.packed = false;
+        value.type = Type::UNDEFINED;
+        return;
+    }
     switch (type = value.type) {
-        case Type::NUMBER: numberValue = value.numberValue; break;
+        case Type::NUMBER: assignNumber(value); break;
         case Type::BOOLEAN: booleanValue = value.booleanValue; break;
         case Type::NULL_: nullValue = value.nullValue; break;
-        case Type::STRING: new (&stringValue) String(std::move(value.stringValue)); break;
-        case Type::OBJECT: new (&objectValue) Object(std::move(value.objectValue)); break;
-        case Type::ARRAY: new (&arrayValue) Array(std::move(value.arrayValue)); break;
+        case Type::STRING: stringBlock = value.stringBlock; break;
+        case Type::OBJECT: objectBlock = value.objectBlock; break;
+        case Type::ARRAY: arrayBlock = value.arrayBlock; break;
     }
+    // the block now belongs to this value
+    value.type = Type::UNDEFINED;
 }
 
 Value::Value() : type(Type::UNDEFINED) {}
-Value::Value(const Value& value) { assignValue(value); }
-Value::Value(Value&& value) { assignValue(std::move(value)); }
+Value::Value(const Value& value) : type(Type::UNDEFINED) { assignValue(value); }
+Value::Value(Value&& value) noexcept { assignValue(std::move(value)); }
 
-Value::Value(Number value) : type(Type::NUMBER), numberValue(value) {}
+Value::Value(Number value) : type(Type::NUMBER), numberType(NumberType::DOUBLE), numberValue(value) {}
+Value::Value(Integer value) : type(Type::NUMBER), numberType(NumberType::INT64), integerValue(value) {}
+// an unsigned integer in the range of INT64 is stored as INT64, like the lexer does, so that it can be packed with the others
+Value::Value(Unsigned value) : type(Type::NUMBER), numberType(value <= INT64_MAX ? NumberType::INT64 : NumberType::UINT64), unsignedValue(value) {}
 Value::Value(Boolean value) : type(Type::BOOLEAN), booleanValue(value) {}
 Value::Value(Null value) : type(Type::NULL_), nullValue(value) {}
-Value::Value(const String& value) : type(Type::STRING), stringValue(value) {}
-Value::Value(String&& value) : type(Type::STRING), stringValue(std::move(value)) {}
-Value::Value(const Object& value) : type(Type::OBJECT), objectValue(value) {}
-Value::Value(Object&& value) : type(Type::OBJECT), objectValue(std::move(value)) {}
-Value::Value(const Array& value) : type(Type::ARRAY), arrayValue(value) {}
-Value::Value(Array&& value) : type(Type::ARRAY), arrayValue(std::move(value)) {}
+Value::Value(const String& value) : type(Type::STRING), stringBlock(createBlock<String>(value)) {}
+Value::Value(String&& value) : type(Type::STRING), stringBlock(createBlock<String>(std::move(value))) {}
+Value::Value(const Object& value) : type(Type::OBJECT), objectBlock(createBlock<Object>(value)) {}
+Value::Value(Object&& value) : type(Type::OBJECT), objectBlock(createBlock<Object>(std::move(value))) {}
+Value::Value(const Array& value) : type(Type::ARRAY), arrayBlock(createBlock<Array>(value)) {}
+Value::Value(Array&& value) : type(Type::ARRAY), arrayBlock(createBlock<Array>(std::move(value))) {}
 
 Value::~Value() { clearValue(); }
 
 Type Value::getType() const { return type; }
 bool Value::hasType(Type type) const { return this->type == type; }
 bool Value::isUndefined() const { return this->type == Type::UNDEFINED; }
+bool Value::isLazy() const { return lazy; }
+bool Value::isPacked() const { return packed; }
+bool Value::isPacked(Type type, NumberType numberType) const {
+    return packed && packedBlock->value.type == type && (type == Type::BOOLEAN || packedBlock->value.numberType == numberType);
+}
 void Value::assertType(Type type) const { if (this->type != type) throw TypeAssertionError(type); }
+NumberType Value::getNumberType() const { assertType(Type::NUMBER); return numberType; }
 
 void Value::clear() { clearValue(); type = Type::UNDEFINED; }
 void Value::assign(const Value& value) {
-    if (type == value.type) {
+    if (type == value.type && !lazy && !value.lazy && !packed && !value.packed) {
+        // a string is copied in place if its block is not shared, but an object or an array is not since the value
+        // can be one of its children, which replacing the content would destroy during the copy
         switch (type) {
-            case Type::NUMBER: numberValue = value.numberValue; break;
-            case Type::BOOLEAN: booleanValue = value.booleanValue; break;
-            case Type::NULL_: nullValue = value.nullValue; break;
-            case Type::STRING: stringValue = value.stringValue; break;
-            case Type::OBJECT: objectValue = value.objectValue; break;
-            case Type::ARRAY: arrayValue = value.arrayValue; break;
+            case Type::NUMBER: assignNumber(value); return;
+            case Type::BOOLEAN: booleanValue = value.booleanValue; return;
+            case Type::NULL_: nullValue = value.nullValue; return;
+            case Type::STRING:
+                if (!value.stringBlock->shared.load(std::memory_order_relaxed) && isUnique(stringBlock)) {
+                    stringBlock->value = value.stringBlock->value;
+                    resetHash();
+                    return;
+                }
+                break;
         }
-    } else {
-        clearValue();
-        assignValue(value);
     }
+    Value copy(value);
+    clearValue();
+    assignValue(std::move(copy));
+}
+Value Value::share() const {
+    markShared();
+    return *this;
 }
+
 void Value::assign(Value&& value) {
-    if (type == value.type) {
-        switch (type) {
-            case Type::NUMBER: numberValue = value.numberValue; break;
-            case Type::BOOLEAN: booleanValue = value.booleanValue; break;
-            case Type::NULL_: nullValue = value.nullValue; break;
-            case Type::STRING: stringValue = std::move(value.stringValue); break;
-            case Type::OBJECT: objectValue = std::move(value.objectValue); break;
-            case Type::ARRAY: arrayValue = std::move(value.arrayValue); break;
-        }
-    } else {
+    if (this != &value) {
+        // the value can be a child of this value
+        Value moved(std::move(value));
         clearValue();
-        assignValue(value);
+        assignValue(std::move(moved));
     }
 }
 
-Number& Value::getNumberValue() { assertType(Type::NUMBER); return numberValue; }
+// the references are to the stored number, which is never converted by reading it
+Number& Value::getNumberValue() { assertType(Type::NUMBER); if (numberType != NumberType::DOUBLE) throw NumberConversionError(NumberType::DOUBLE); return numberValue; }
+Integer& Value::getIntegerValue() { assertType(Type::NUMBER); if (numberType != NumberType::INT64) throw NumberConversionError(NumberType::INT64); return integerValue; }
+Unsigned& Value::getUnsignedValue() { assertType(Type::NUMBER); if (numberType != NumberType::UINT64) throw NumberConversionError(NumberType::UINT64); return unsignedValue; }
 Boolean& Value::getBooleanValue() { assertType(Type::BOOLEAN); return booleanValue; }
 Null& Value::getNullValue() { assertType(Type::NULL_); return nullValue; }
-String& Value::getStringValue() { assertType(Type::STRING); return stringValue; }
-Object& Value::getObjectValue() { assertType(Type::OBJECT); return objectValue; }
-Array& Value::getArrayValue() { assertType(Type::ARRAY); return arrayValue; }
-
-Number Value::getNumberValue() const { assertType(Type::NUMBER); return numberValue; }
+String& Value::getStringValue() { assertType(Type::STRING); detach(); return stringBlock->value; }
+Object& Value::getObjectValue() { assertType(Type::OBJECT); detach(); return objectBlock->value; }
+Array& Value::getArrayValue() { assertType(Type::ARRAY); detach(); return arrayBlock->value; }
+
+Number Value::getNumberValue() const {
+    assertType(Type::NUMBER);
+    switch (numberType) {
+        case NumberType::INT64: return integerValue;
+        case NumberType::UINT64: return unsignedValue;
+        default: return numberValue;
+    }
+}
+Integer Value::getIntegerValue() const {
+    assertType(Type::NUMBER);
+    Integer integer;
+    switch (numberType) {
+        case NumberType::INT64: return integerValue;
+        case NumberType::UINT64: if (unsignedValue <= INT64_MAX) return unsignedValue; break;
+        default: if (toInteger(numberValue, integer)) return integer; break;
+    }
+    throw NumberConversionError(NumberType::INT64);
+}
+Unsigned Value::getUnsignedValue() const {
+    assertType(Type::NUMBER);
+    Unsigned integer;
+    switch (numberType) {
+        case NumberType::INT64: if (integerValue >= 0) return integerValue; break;
+        case NumberType::UINT64: return unsignedValue;
+        default: if (toUnsigned(numberValue, integer)) return integer; break;
+    }
+    throw NumberConversionError(NumberType::UINT64);
+}
 Boolean Value::getBooleanValue() const { assertType(Type::BOOLEAN); return booleanValue; }
 Null Value::getNullValue() const { assertType(Type::NULL_); return nullValue; }
-const String& Value::getStringValue() const { assertType(Type::STRING); return stringValue; }
-const Object& Value::getObjectValue() const { assertType(Type::OBJECT); return objectValue; }
-const Array& Value::getArrayValue() const { assertType(Type::ARRAY); return arrayValue; }
+const String& Value::getStringValue() const { assertType(Type::STRING); return stringBlock->value; }
+const Object& Value::getObjectValue() const { assertType(Type::OBJECT); materialize(); return objectBlock->value; }
+const Array& Value::getArrayValue() const { assertType(Type::ARRAY); materialize(); return packed ? packedBlock->value.getArray() : arrayBlock->value; }
 
-void Value::setNumberValue(Number value) { clearValue(); type = Type::NUMBER; numberValue = value; }
+Span<const Number> Value::getNumberSpan() const {
+    if (!isPacked(Type::NUMBER, NumberType::DOUBLE)) throw TypeAssertionError(Type::NUMBER);
+    return Span<const Number>(packedBlock->value.get<Number>(), packedBlock->value.size);
+}
+Span<const Integer> Value::getIntegerSpan() const {
+    if (!isPacked(Type::NUMBER, NumberType::INT64)) throw TypeAssertionError(Type::NUMBER);
+    return Span<const Integer>(packedBlock->value.get<Integer>(), packedBlock->value.size);
+}
+Span<const Boolean> Value::getBooleanSpan() const {
+    if (!isPacked(Type::BOOLEAN)) throw TypeAssertionError(Type::BOOLEAN);
+    return Span<const Boolean>(packedBlock->value.get<Boolean>(), packedBlock->value.size);
+}
+
+size_t Value::getArraySize() const {
+    assertType(Type::ARRAY);
+    materialize();
+    return packed ? packedBlock->value.size : arrayBlock->value.size();
+}
+
+Value Value::getElement(size_t index) const {
+    if (index >= getArraySize()) {
+        throw KeyError(std::to_string(index));
+    }
+    if (packed) {
+        return packedBlock->value.getElement(index);
+    }
+    return arrayBlock->value[index];
+}
+
+bool Value::pack() {
+
+    if (type != Type::ARRAY || lazy) {
+        return false;
+    }
+    if (packed) {
+        return true;
+    }
+
+    const Array& array = arrayBlock->value;
+    if (array.empty()) {
+        return false;
+    }
+    Type elementType = array[0].type;
+    NumberType elementNumberType = array[0].numberType;
+    if (elementType != Type::BOOLEAN && (elementType != Type::NUMBER || elementNumberType == NumberType::UINT64)) {
+        return false;
+    }
+    for (const Value& value : array) {
+        if (value.type != elementType || (elementType == Type::NUMBER && value.numberType != elementNumberType)) {
+            return false;
+        }
+    }
+
+    Block<Packed>* block = createBlock<Packed>(elementType, elementNumberType, array.size());
+    Packed& elements = block->value;
+    for (size_t index = 0; index < array.size(); index++) {
+        if (elementType == Type::BOOLEAN) {
+            elements.get<Boolean>()[index] = array[index].booleanValue;
+        } else if (elementNumberType == NumberType::INT64) {
+            elements.get<Integer>()[index] = array[index].integerValue;
+        } else {
+            elements.get<Number>()[index] = array[index].numberValue;
+        }
+    }
+    clearValue();
+    packedBlock = block;
+    packed = true;
+    return true;
+}
+
+// replaces the packed elements with values, which can then be modified
+void Value::unpack() {
+    const Packed& elements = packedBlock->value;
+    Block<Array>* block = createBlock<Array>();
+    block->value.reserve(elements.size);
+    elements.forEach([&](auto element) { block->value.emplace_back(element); });
+    destroyBlock(packedBlock);
+    packed = false;
+    arrayBlock = block;
+}
+
+void Value::setNumberValue(Number value) { clearValue(); type = Type::NUMBER; numberType = NumberType::DOUBLE; numberValue = value; }
+void Value::setIntegerValue(Integer value) { clearValue(); type = Type::NUMBER; numberType = NumberType::INT64; integerValue = value; }
+void Value::setUnsignedValue(Unsigned value) { clearValue(); type = Type::NUMBER; numberType = NumberType::UINT64; unsignedValue = value; }
 void Value::setBooleanValue(Boolean value) { clearValue(); type = Type::BOOLEAN; booleanValue = value; }
 void Value::setNullValue(Null value) { clearValue(); type = Type::NULL_; nullValue = value; }
-void Value::setStringValue(String&& value) { if (type == Type::STRING) { stringValue = std::move(value); } else { clearValue(); type = Type::STRING; new (&stringValue) String(std::move(value)); } }
-void Value::setObjectValue(Object&& value) { if (type == Type::OBJECT) { objectValue = std::move(value); } else { clearValue(); type = Type::OBJECT; new (&objectValue) Object(std::move(value)); } }
-void Value::setArrayValue(Array&& value) { if (type == Type::ARRAY) { arrayValue = std::move(value); } else { clearValue(); type = Type::ARRAY; new (&arrayValue) Array(std::move(value)); } }
+void Value::setStringValue(String&& value) { if (type == Type::STRING && isUnique(stringBlock)) { stringBlock->value = std::move(value); resetHash(); } else { Block<String>* block = createBlock<String>(std::move(value)); clearValue(); type = Type::STRING; stringBlock = block; } }
+void Value::setObjectValue(Object&& value) { Block<Object>* block = createBlock<Object>(std::move(value)); clearValue(); type = Type::OBJECT; objectBlock = block; }
+void Value::setArrayValue(Array&& value) { Block<Array>* block = createBlock<Array>(std::move(value)); clearValue(); type = Type::ARRAY; arrayBlock = block; }
 
-void Value::setStringValue(const String& value) { if (type == Type::STRING) { stringValue = value; } else { clearValue(); type = Type::STRING; new (&stringValue) String(value); } }
-void Value::setObjectValue(const Object& value) { if (type == Type::OBJECT) { objectValue = value; } else { clearValue(); type = Type::OBJECT; new (&objectValue) Object(value); } }
-void Value::setArrayValue(const Array& value) { if (type == Type::ARRAY) { arrayValue = value; } else { clearValue(); type = Type::ARRAY; new (&arrayValue) Array(value); } }
+void Value::setStringValue(const String& value) { if (type == Type::STRING && isUnique(stringBlock)) { stringBlock->value = value; resetHash(); } else { Block<String>* block = createBlock<String>(value); clearValue(); type = Type::STRING; stringBlock = block; } }
+void Value::setObjectValue(const Object& value) { Block<Object>* block = createBlock<Object>(value); clearValue(); type = Type::OBJECT; objectBlock = block; }
+void Value::setArrayValue(const Array& value) { Block<Array>* block = createBlock<Array>(value); clearValue(); type = Type::ARRAY; arrayBlock = block; }
 
 Value& Value::operator=(const Value& value) { assign(value); return *this; }
 Value& Value::operator=(Value&& value) { assign(std::move(value)); return *this; }
 
 Value& Value::operator=(Number value) { setNumberValue(value); return *this; }
+Value& Value::operator=(Integer value) { setIntegerValue(value); return *this; }
+Value& Value::operator=(Unsigned value) { if (value <= INT64_MAX) setIntegerValue((Integer)value); else setUnsignedValue(value); return *this; }
 Value& Value::operator=(Boolean value) { setBooleanValue(value); return *this; }
 Value& Value::operator=(Null value) { setNullValue(value); return *this; }
 Value& Value::operator=(String&& value) { setStringValue(std::move(value)); return *this; }
@@ -146,19 +714,304 @@ Value& Value::operator=(const Array& value) { setArrayValue(value); return *this
 bool Value::operator!=(const Value& value) const { return !(*this == value); }
 bool Value::operator==(const Value& value) const {
     if (type == value.type) {
+        materialize();
+        value.materialize();
         switch (type) {
-            case Type::NUMBER: return numberValue == value.numberValue;
+            case Type::NUMBER: {
+                if (numberType == value.numberType) {
+                    switch (numberType) {
+                        case NumberType::INT64: return integerValue == value.integerValue;
+                        case NumberType::UINT64: return unsignedValue == value.unsignedValue;
+                        default: return numberValue == value.numberValue;
+                    }
+                }
+                // compare the exact values of different representations
+                const Value& first = numberType < value.numberType ? *this : value;
+                const Value& second = numberType < value.numberType ? value : *this;
+                Integer integer;
+                Unsigned unsignedInteger;
+                if (first.numberType == NumberType::DOUBLE) {
+                    return second.numberType == NumberType::INT64 ?
+                        toInteger(first.numberValue, integer) && integer == second.integerValue :
+                        toUnsigned(first.numberValue, unsignedInteger) && unsignedInteger == second.unsignedValue;
+                }
+                return first.integerValue >= 0 && (Unsigned)first.integerValue == second.unsignedValue;
+            }
             case Type::BOOLEAN: return booleanValue == value.booleanValue;
             case Type::NULL_: return true;
-            case Type::STRING: return stringValue == value.stringValue;
-            case Type::OBJECT: return objectValue == value.objectValue;
-            case Type::ARRAY: return arrayValue == value.arrayValue;
+            case Type::STRING: return equalBlocks(stringBlock, value.stringBlock);
+            case Type::OBJECT: return equalBlocks(objectBlock, value.objectBlock);
+            case Type::ARRAY: return packed || value.packed ? equalArrays(value) : equalBlocks(arrayBlock, value.arrayBlock);
         }
     }
     return false;
 }
 
+// compares two arrays of which at least one is packed
+bool Value::equalArrays(const Value& value) const {
+    if (packed && value.packed && packedBlock->value.hasSameType(value.packedBlock->value)) {
+        return equalBlocks(packedBlock, value.packedBlock);
+    }
+    // the elements of different types are compared one by one without building the arrays of values
+    const Value& first = packed ? *this : value;
+    const Value& second = packed ? value : *this;
+    const Packed& elements = first.packedBlock->value;
+    size_t size = second.packed ? second.packedBlock->value.size : second.arrayBlock->value.size();
+    if (elements.size != size) {
+        return false;
+    }
+    for (size_t index = 0; index < size; index++) {
+        Value element = elements.getElement(index);
+        if (second.packed ? element != second.packedBlock->value.getElement(index) : element != second.arrayBlock->value[index]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Mixes the bits of an integer so that close integers have unrelated hashes (the finalizer of splitmix64).
+ */
+static size_t mixHash(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+static size_t combineHash(size_t seed, size_t hash) {
+    return mixHash(seed + 0x9e3779b97f4a7c15 + hash);
+}
+
+size_t Value::hash() const {
+    materialize();
+    switch (type) {
+        case Type::NUMBER: {
+            // equal numbers of different representations have the hash of the integer
+            Integer integer;
+            Unsigned unsignedInteger;
+            switch (numberType) {
+                case NumberType::INT64: return mixHash(integerValue);
+                case NumberType::UINT64: return mixHash(unsignedValue);
+                default:
+                    if (toInteger(numberValue, integer)) {
+                        return mixHash(integer);
+                    }
+                    if (toUnsigned(numberValue, unsignedInteger)) {
+                        return mixHash(unsignedInteger);
+                    }
+                    uint64_t bits;
+                    memcpy(&bits, &numberValue, sizeof(bits));
+                    return mixHash(bits);
+            }
+        }
+        case Type::BOOLEAN: return combineHash((size_t)type, booleanValue);
+        case Type::NULL_: return combineHash((size_t)type, 0);
+        case Type::STRING:
+            return getCachedHash(stringBlock, [](const String& string) {
+                return combineHash((size_t)Type::STRING, std::hash<String>()(string));
+            });
+        case Type::OBJECT:
+            return getCachedHash(objectBlock, [](const Object& object) {
+                // the members are summed so that the hash does not depend on their order
+                size_t hash = combineHash((size_t)Type::OBJECT, object.size());
+                for (const auto& item : object) {
+                    hash += combineHash(item.first.hash(), item.second.hash());
+                }
+                return hash;
+            });
+        case Type::ARRAY:
+            if (packed) {
+                // the same hash as the array of values
+                return getCachedHash(packedBlock, [](const Packed& elements) {
+                    size_t hash = combineHash((size_t)Type::ARRAY, elements.size);
+                    elements.forEach([&](auto element) { hash = combineHash(hash, Value(element).hash()); });
+                    return hash;
+                });
+            }
+            return getCachedHash(arrayBlock, [](const Array& array) {
+                size_t hash = combineHash((size_t)Type::ARRAY, array.size());
+                for (const Value& value : array) {
+                    hash = combineHash(hash, value.hash());
+                }
+                return hash;
+            });
+        default: throw UndefinedValueError();
+    }
+}
+
+size_t Value::MemoryUsage::getTotal() const {
+    return nodes + strings + keys + slack;
+}
+
+static void addUsage(Value::MemoryUsage& usage, const Value::MemoryUsage& other, bool add) {
+    if (add) {
+        usage.nodes += other.nodes, usage.strings += other.strings, usage.keys += other.keys;
+        usage.slack += other.slack, usage.shared += other.shared;
+    } else {
+        usage.nodes -= other.nodes, usage.strings -= other.strings, usage.keys -= other.keys;
+        usage.slack -= other.slack, usage.shared -= other.shared;
+    }
+}
+
+// the characters of a string are in a separate allocation unless it is short enough to be stored inline
+static void measureString(const std::string& string, Value::MemoryUsage& usage) {
+    const char* data = string.data();
+    if (data < reinterpret_cast<const char*>(&string) || data >= reinterpret_cast<const char*>(&string + 1)) {
+        usage.strings += string.size() + 1;
+        usage.slack += string.capacity() - string.size();
+    }
+}
+
+/**
+ * The state of a walk that measures a value.
+ * The running total is measured before and after each subtree, the difference is its usage.
+ * The blocks referenced by several values and the texts of lazy values are only measured on their first visit.
+ * The heaviest subtrees are kept in a min-heap, with the path to the current subtree to name them.
+ */
+struct Value::MemoryMeter {
+
+    struct Step {
+        const Key* key;
+        size_t index;
+    };
+
+    MemoryUsage usage;
+    std::unordered_set<const void*> visited;
+    std::vector<Step> steps;
+    std::vector<SubtreeUsage> heaviest;
+    size_t count = 0;
+
+    static bool heavier(const SubtreeUsage& first, const SubtreeUsage& second) {
+        return first.usage.getTotal() > second.usage.getTotal();
+    }
+
+    std::string getPath() const {
+        std::string path = "$";
+        for (const Step& step : steps) {
+            if (step.key == nullptr) {
+                path += ".[" + std::to_string(step.index) + "]";
+            } else {
+                char quote = step.key->view().find('\'') == std::string_view::npos ? '\'' : '"';
+                path.append(".[").append(1, quote).append(step.key->view()).append(1, quote).append("]");
+            }
+        }
+        return path;
+    }
+
+    void report(const MemoryUsage& before) {
+        MemoryUsage subtree = usage;
+        addUsage(subtree, before, false);
+        if (heaviest.size() == count && (count == 0 || subtree.getTotal() <= heaviest.front().usage.getTotal())) {
+            return;
+        }
+        if (heaviest.size() == count) {
+            std::pop_heap(heaviest.begin(), heaviest.end(), heavier);
+            heaviest.pop_back();
+        }
+        heaviest.push_back({ getPath(), subtree });
+        std::push_heap(heaviest.begin(), heaviest.end(), heavier);
+    }
+};
+
+void Value::measure(MemoryMeter& meter) const {
+
+    if (type != Type::STRING && type != Type::OBJECT && type != Type::ARRAY) {
+        return;
+    }
+
+    // a block referenced by other values is measured on its first visit
+    const void* block;
+    uint32_t references;
+    if (lazy) {
+        block = lazyBlock, references = lazyBlock->references.load(std::memory_order_relaxed);
+    } else if (packed) {
+        block = packedBlock, references = packedBlock->references.load(std::memory_order_relaxed);
+    } else if (type == Type::STRING) {
+        block = stringBlock, references = stringBlock->references.load(std::memory_order_relaxed);
+    } else if (type == Type::OBJECT) {
+        block = objectBlock, references = objectBlock->references.load(std::memory_order_relaxed);
+    } else {
+        block = arrayBlock, references = arrayBlock->references.load(std::memory_order_relaxed);
+    }
+    bool shared = references > 1;
+    if (shared && !meter.visited.insert(block).second) {
+        return;
+    }
+
+    MemoryUsage& usage = meter.usage;
+    MemoryUsage before = usage;
+
+    if (lazy) {
+        usage.nodes += sizeof(Block<Lazy>);
+        const std::string& source = *lazyBlock->value.source;
+        if (meter.visited.insert(&source).second) {
+            measureString(source, usage);
+        }
+    } else if (packed) {
+        // the array of values built by the const getters is counted as nodes and slack too
+        const Packed& elements = packedBlock->value;
+        usage.nodes += sizeof(Block<Packed>) + elements.getDataSize();
+        const Array* array = elements.unpacked.load(std::memory_order_acquire);
+        if (array != nullptr) {
+            usage.nodes += sizeof(Array) + array->size() * sizeof(Value);
+            usage.slack += (array->capacity() - array->size()) * sizeof(Value);
+        }
+    } else if (type == Type::STRING) {
+        usage.nodes += sizeof(Block<String>);
+        measureString(stringBlock->value, usage);
+    } else if (type == Type::OBJECT) {
+        const Object& object = objectBlock->value;
+        usage.nodes += sizeof(Block<Object>);
+#if defined(JSON_FLAT_OBJECT) || defined(JSON_HASH_OBJECT)
+        usage.nodes += object.size() * sizeof(Object::value_type);
+        usage.slack += object.allocated_size() - object.size() * sizeof(Object::value_type);
+#else
+        usage.nodes += object.size() * (sizeof(Object::value_type) + 4 * sizeof(void*));
+#endif
+        for (const auto& member : object) {
+            usage.keys += member.first.getAllocatedSize();
+            meter.steps.push_back({ &member.first, 0 });
+            member.second.measure(meter);
+            meter.steps.pop_back();
+        }
+    } else {
+        const Array& array = arrayBlock->value;
+        usage.nodes += sizeof(Block<Array>) + array.size() * sizeof(Value);
+        usage.slack += (array.capacity() - array.size()) * sizeof(Value);
+        for (size_t index = 0; index < array.size(); index++) {
+            meter.steps.push_back({ nullptr, index });
+            array[index].measure(meter);
+            meter.steps.pop_back();
+        }
+    }
+
+    if (shared) {
+        MemoryUsage subtree = usage;
+        addUsage(subtree, before, false);
+        usage.shared += subtree.getTotal() - subtree.shared;
+    }
+
+    if (meter.count > 0) {
+        meter.report(before);
+    }
+}
+
+Value::MemoryUsage Value::getMemoryUsage() const {
+    MemoryMeter meter;
+    measure(meter);
+    return meter.usage;
+}
+
+std::vector<Value::SubtreeUsage> Value::getHeaviestSubtrees(size_t count) const {
+    MemoryMeter meter;
+    meter.count = count;
+    measure(meter);
+    std::sort_heap(meter.heaviest.begin(), meter.heaviest.end(), MemoryMeter::heavier);
+    return std::move(meter.heaviest);
+}
+
 Value& Value::operator[](const String& key) {
+    detach();
     return const_cast<Value&>(static_cast<const Value&>(*this)[key]);
 }
 const Value& Value::operator[](const String& key) const {
@@ -171,6 +1024,7 @@ const Value& Value::operator[](const String& key) const {
 }
 
 Value& Value::operator[](size_t index) {
+    detach();
     return const_cast<Value&>(static_cast<const Value&>(*this)[index]);
 }
 
@@ -182,138 +1036,308 @@ const Value& Value::operator[](size_t index) const {
     throw KeyError(std::to_string(index));
 }
 
+/**
+ * Tells whether a container can be reserved, objects can only be reserved if they are not a std::map.
+ */
+template <class T, class = void>
+struct HasReserve : std::false_type {};
+
+template <class T>
+struct HasReserve<T, std::void_t<decltype(std::declval<T&>().reserve(0))>> : std::true_type {};
+
+/**
+ * Tells whether the entries of an object can be extracted as nodes, which is only the case for a std::map.
+ */
+template <class T, class = void>
+struct HasExtract : std::false_type {};
+
+template <class T>
+struct HasExtract<T, std::void_t<decltype(std::declval<T&>().extract(std::declval<T&>().begin()))>> : std::true_type {};
+
+// counts the values of each object and array of a text, in the order of their starts, without checking the syntax
+static void scanSizes(std::string_view text, std::vector<size_t>& sizes) {
+
+    std::vector<size_t> open;
+    const char* end = text.data() + text.size();
+    char last = '\0';
+
+    for (const char* c = text.data(); c < end; c++) {
+        switch (*c) {
+            case '\"':
+                // the quote ends the string unless it is escaped by an odd number of backslashes
+                for (;;) {
+                    c = static_cast<const char*>(memchr(c + 1, '\"', end - c - 1));
+                    if (c == nullptr) {
+                        return;
+                    }
+                    const char* escape = c;
+                    while (escape[-1] == '\\') {
+                        escape--;
+                    }
+                    if ((c - escape) % 2 == 0) {
+                        break;
+                    }
+                }
+                last = '\"';
+                break;
+            case '{':
+            case '[':
+                open.push_back(sizes.size());
+                sizes.push_back(0);
+                last = *c;
+                break;
+            case ',':
+                if (!open.empty()) {
+                    sizes[open.back()]++;
+                }
+                last = ',';
+                break;
+            case '}':
+            case ']':
+                // there is one more value than commas, unless the container is empty
+                if (!open.empty()) {
+                    if (last != '{' && last != '[') {
+                        sizes[open.back()]++;
+                    }
+                    open.pop_back();
+                }
+                last = *c;
+                break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                break;
+            default:
+                last = *c;
+                break;
+        }
+    }
+}
+
 class ValueParser : public Parser {
 
     Value& root;
     std::vector<Value*> stack;
     std::string key;
 
+    // the size of the last object or array closed at each depth, sibling containers often have the same size
+    std::vector<size_t> sizeHints;
+
+    // the exact sizes of the objects and arrays in the order of their starts, if the text was scanned
+    const std::vector<size_t>* scannedSizes;
+    size_t scannedIndex = 0;
+
+    // the learned sizes of the current containers (see SizeHints), nullptr where nothing is learned
+    SizeHints* hints;
+    std::vector<SizeHints::Node*> nodes;
+
     void checkStack() {
         if (stack.empty()) {
             root.clear();
             stack.push_back(&root);
+            nodes.assign(1, nullptr);
         }
     }
 
-    void onNumber(double value) override {
-        checkStack();
-        switch (stack.back()->getType()) {
-            case Type::ARRAY: stack.back()->getArrayValue().push_back(value); break;
-            case Type::OBJECT: stack.back()->getObjectValue()[key] = value; break;
-            default: stack.back()->setNumberValue(value); break;
+    SizeHints::Node* getChildNode() {
+        if (hints == nullptr) {
+            return nullptr;
         }
-    }
-
-    void onBoolean(bool value) override {
-        checkStack();
-        switch (stack.back()->getType()) {
-            case Type::ARRAY: stack.back()->getArrayValue().push_back(value); break;
-            case Type::OBJECT: stack.back()->getObjectValue()[key] = value; break;
-            default: stack.back()->setBooleanValue(value); break;
+        Type type = stack.back()->getType();
+        if (type != Type::ARRAY && type != Type::OBJECT) {
+            return hints->getRoot();
         }
-    }
-
-    void onNull() override {
-        checkStack();
-        switch (stack.back()->getType()) {
-            case Type::ARRAY: stack.back()->getArrayValue().push_back(null); break;
-            case Type::OBJECT: stack.back()->getObjectValue()[key] = null; break;
-            default: stack.back()->setNullValue(); break;
+        SizeHints::Node* parent = nodes.back();
+        if (parent == nullptr) {
+            return nullptr;
         }
+        return type == Type::ARRAY ? parent->getElements() : parent->getMember(key);
     }
 
-    void onString(std::string& value) override {
+    /**
+     * Adds a value to the current object or array, or sets the current value.
+     * The key and the value are moved into an entry constructed in place.
+     */
+    template <class T>
+    Value& add(T&& value) {
         checkStack();
-        switch (stack.back()->getType()) {
-            case Type::ARRAY: stack.back()->getArrayValue().push_back(value); break;
-            case Type::OBJECT: stack.back()->getObjectValue()[key] = value; break;
-            default: stack.back()->setStringValue(value); break;
+        Value& parent = *stack.back();
+        switch (parent.getType()) {
+            case Type::ARRAY:
+                return parent.getArrayValue().emplace_back(std::forward<T>(value));
+            case Type::OBJECT: {
+                auto result = parent.getObjectValue().try_emplace(std::move(key), std::forward<T>(value));
+                if (!result.second) {
+                    // the value is not moved by try_emplace if the key already exists
+                    result.first->second = std::forward<T>(value);
+                }
+                return result.first->second;
+            }
+            default:
+                parent = std::forward<T>(value);
+                return parent;
         }
     }
 
-    void onKey(std::string& key) override {
-        this->key = std::move(key);
-    }
+    template <class T>
+    void startContainer() {
 
-    void onIndex(size_t index) override {
+        checkStack();
 
+        // the node is found before the key is moved into the parent
+        SizeHints::Node* node = getChildNode();
+        Type type = stack.back()->getType();
+        if (type == Type::ARRAY || type == Type::OBJECT) {
+            stack.push_back(&add(T()));
+        } else {
+            // the current value is the root, it stays at the bottom of the stack
+            *stack.back() = T();
+        }
+        nodes.resize(stack.size());
+        nodes.back() = node;
+
+        // the scanned size is exact, the learned and sibling sizes are guesses
+        size_t depth = stack.size() - 1;
+        size_t size = 0;
+        if (scannedSizes != nullptr && scannedIndex < scannedSizes->size()) {
+            size = (*scannedSizes)[scannedIndex++];
+        } else if (node != nullptr && node->getSize() > 0) {
+            size = node->getSize();
+        } else if (depth < sizeHints.size()) {
+            size = sizeHints[depth];
+        }
+        if (size > 0) {
+            if constexpr (std::is_same<T, Array>::value) {
+                reserve(stack.back()->getArrayValue(), size);
+            } else {
+                reserve(stack.back()->getObjectValue(), size);
+            }
+        }
     }
 
-    void onObjectStart() override {
-        checkStack();
-        switch (stack.back()->getType()) {
-            case Type::ARRAY: {
-                Array& arrayValue = stack.back()->getArrayValue();
-                arrayValue.emplace_back(Object());
-                stack.push_back(&arrayValue.back());
-                break;
-            }
-            case Type::OBJECT: {
-                Object& object = stack.back()->getObjectValue();
-                stack.push_back(&(object[key] = Object()));
-                break;
-            }
-            default:
-                stack.back()->setObjectValue();
-                break;
+    template <class T>
+    static void reserve(T& container, size_t size) {
+        if constexpr (HasReserve<T>::value) {
+            container.reserve(size);
         }
     }
 
-    void onObjectEnd() override {
+    void endContainer(size_t size) {
+        size_t depth = stack.size() - 1;
+        if (depth >= sizeHints.size()) {
+            sizeHints.resize(depth + 1);
+        }
+        sizeHints[depth] = size;
+        if (nodes.back() != nullptr) {
+            nodes.back()->setSize(size);
+        }
         stack.pop_back();
+        nodes.pop_back();
     }
 
-    void onArrayStart() override {
-        checkStack();
-        switch (stack.back()->getType()) {
-            case Type::ARRAY: {
-                Array& arrayValue = stack.back()->getArrayValue();
-                arrayValue.emplace_back(Array());
-                stack.push_back(&arrayValue.back());
-                break;
-            }
-            case Type::OBJECT: {
-                Object& object = stack.back()->getObjectValue();
-                stack.push_back(&(object[key] = Array()));
-                break;
+    // the large arrays of numbers or booleans are packed, the capacity of the others reserved from
+    // a wrong guess is released if more than a quarter of it is unused
+    void endArray() {
+        Value& value = *stack.back();
+        Array& array = value.getArrayValue();
+        size_t size = array.size();
+        if (size < Value::packedMinSize || !value.pack()) {
+            if ((array.capacity() - size) * 4 > array.capacity()) {
+                array.shrink_to_fit();
             }
-            default:
-                stack.back()->setObjectValue();
-                break;
         }
+        endContainer(size);
     }
 
-    void onArrayEnd() override {
-        stack.pop_back();
-    }
+    void onNumber(double value) override { add(value); }
+    void onInteger(int64_t value) override { add(value); }
+    void onUnsigned(uint64_t value) override { add(value); }
+    void onBoolean(bool value) override { add(value); }
+    void onNull() override { add(null); }
+    // the strings and keys are copied at their size instead of being moved, so that the buffers of the parser keep
+    // their capacity and the next long strings are read without growing them again
+    void onString(std::string& value) override { add(String(value)); }
+    void onKey(std::string& key) override { this->key.assign(key); }
+    void onIndex(size_t index) override {}
+
+    void onObjectStart() override { startContainer<Object>(); }
+    void onObjectEnd() override { endContainer(stack.back()->getObjectValue().size()); }
+    void onArrayStart() override { startContainer<Array>(); }
+    void onArrayEnd() override { endArray(); }
 
 public:
 
-    ValueParser(Value& value, bool unique) : root(value), stack{&value} {
+    ValueParser(Value& value, bool unique, const std::vector<size_t>* scannedSizes = nullptr) :
+        root(value), stack{&value}, scannedSizes(scannedSizes), hints(SizeHints::getCurrent()), nodes{nullptr} {
         if (!unique) {
             value.setArrayValue();
+            if (hints != nullptr) {
+                nodes.back() = hints->getRoot();
+            }
         }
     }
 };
 
-void Value::print(Printer& printer) const {
+template <class P>
+void Value::printPacked(P& printer) const {
+    const Packed& elements = packedBlock->value;
+    if constexpr (std::is_same<P, BinaryPrinter>::value) {
+        printer.startArray(elements.size);
+        elements.forEach([&](auto element) { printer.value(element); });
+    } else {
+        // the text printer prints the elements in batches
+        printer.startArray();
+        if (elements.type == Type::BOOLEAN) {
+            printer.values(elements.get<Boolean>(), elements.size);
+        } else if (elements.numberType == NumberType::INT64) {
+            printer.values(elements.get<Integer>(), elements.size);
+        } else {
+            printer.values(elements.get<Number>(), elements.size);
+        }
+    }
+    printer.endArray();
+}
+
+template <class P>
+void Value::printTo(P& printer) const {
+    materialize();
     switch (type) {
-        case Type::NUMBER: printer.value(numberValue); break;
+        case Type::NUMBER:
+            switch (numberType) {
+                case NumberType::INT64: printer.value(integerValue); break;
+                case NumberType::UINT64: printer.value(unsignedValue); break;
+                default: printer.value(numberValue); break;
+            }
+            break;
         case Type::BOOLEAN: printer.value(booleanValue); break;
         case Type::NULL_: printer.value(); break;
-        case Type::STRING: printer.value(stringValue); break;
+        case Type::STRING: printer.value(stringBlock->value); break;
         case Type::OBJECT:
-            printer.startObject();
-            for (auto& key : objectValue) {
-                printer.key(key.first);
-                key.second.print(printer);
+            // a binary printer writes the size of a container in its header
+            if constexpr (std::is_same<P, BinaryPrinter>::value) {
+                printer.startObject(objectBlock->value.size());
+            } else {
+                printer.startObject();
+            }
+            for (auto& key : objectBlock->value) {
+                printer.key(key.first.c_str());
+                key.second.printTo(printer);
             }
             printer.endObject();
             break;
         case Type::ARRAY:
-            printer.startArray();
-            for (auto& value : arrayValue) {
-                value.print(printer);
+            if (packed) {
+                printPacked(printer);
+                break;
+            }
+            if constexpr (std::is_same<P, BinaryPrinter>::value) {
+                printer.startArray(arrayBlock->value.size());
+            } else {
+                printer.startArray();
+            }
+            for (auto& value : arrayBlock->value) {
+                value.printTo(printer);
             }
             printer.endArray();
             break;
@@ -321,6 +1345,14 @@ void Value::print(Printer& printer) const {
     }
 }
 
+void Value::print(Printer& printer) const {
+    printTo(printer);
+}
+
+void Value::print(BinaryPrinter& printer) const {
+    printTo(printer);
+}
+
 void Value::print(std::ostream& output, int indent, bool escapeUnicode, bool color) const {
     Printer printer(output, indent, escapeUnicode, color);
     print(printer);
@@ -331,10 +1363,317 @@ void Value::parse(std::istream& input, const Path& path, bool unique) {
     ValueParser(*this, unique).parse(input, path);
 }
 
+Status Value::tryParse(std::istream& input, const Path& path, bool unique) {
+    clear();
+    return ValueParser(*this, unique).tryParse(input, path);
+}
+
+void Value::parse(const Tape& tape, const Path& path, bool unique) {
+    clear();
+    ValueParser(*this, unique).parse(tape, path);
+}
+
+void Value::parse(std::istream& input, Format format, const Path& path, bool unique) {
+    clear();
+    ValueParser(*this, unique).parse(input, format, path);
+}
+
+void Value::parse(std::string_view text, const Path& path, bool unique) {
+    clear();
+    // the scanned sizes are in the order of all the objects and arrays, so they are only used without a path
+    std::vector<size_t> sizes;
+    if (path.getSize() == 0) {
+        scanSizes(text, sizes);
+    }
+    SpanBuffer buffer(text.data(), text.size());
+    std::istream input(&buffer);
+    ValueParser(*this, unique, path.getSize() == 0 ? &sizes : nullptr).parse(input, path);
+}
+
+Value Value::createLazy(Type type, const std::shared_ptr<const std::string>& source, size_t begin, size_t size) {
+    Value value;
+    value.lazyBlock = createBlock<Lazy>(Lazy{ source, begin, size });
+    value.type = type;
+    value.lazy = true;
+    return value;
+}
+
+void Value::materialize() const {
+
+    if (!lazy) {
+        return;
+    }
+
+    const Lazy& span = lazyBlock->value;
+    SpanBuffer buffer(span.source->data() + span.begin, span.size);
+    std::istream input(&buffer);
+    Lexer lexer(input);
+
+    // reads the value of the current token, objects and arrays are skipped and stay lazy
+    auto readChild = [&]() -> Value {
+        switch (lexer.getToken()) {
+            case Token::OBJECT_START:
+            case Token::ARRAY_START: {
+                Type childType = lexer.getToken() == Token::OBJECT_START ? Type::OBJECT : Type::ARRAY;
+                size_t begin = lexer.getTokenOffset();
+                lexer.skipContainer();
+                if (lexer.getToken() == Token::END_OF_STREAM) {
+                    throw Parser::Error(lexer);
+                }
+                return createLazy(childType, span.source, span.begin + begin, lexer.getOffset() - begin);
+            }
+            case Token::NUMBER:
+                switch (lexer.getNumberType()) {
+                    case NumberType::INT64: return lexer.getIntegerValue();
+                    case NumberType::UINT64: return lexer.getUnsignedValue();
+                    default: return lexer.getNumberValue();
+                }
+            case Token::STRING: return std::move(lexer.getStringValue());
+            case Token::BOOLEAN: return lexer.getBooleanValue();
+            case Token::NULL_: return null;
+            default: throw Parser::Error(lexer);
+        }
+    };
+
+    Value value;
+
+    if (type == Type::OBJECT) {
+        Object object;
+        lexer.nextToken();
+        while (lexer.getToken() != Token::OBJECT_END) {
+            if (!object.empty()) {
+                if (lexer.getToken() != Token::COMMA) {
+                    throw Parser::Error(lexer);
+                }
+                lexer.nextToken();
+            }
+            if (lexer.getToken() != Token::STRING) {
+                throw Parser::Error(lexer);
+            }
+            std::string key = std::move(lexer.getStringValue());
+            lexer.nextToken();
+            if (lexer.getToken() != Token::COLON) {
+                throw Parser::Error(lexer);
+            }
+            lexer.nextToken();
+            object[std::move(key)] = readChild();
+            lexer.nextToken();
+        }
+        value = std::move(object);
+    } else {
+        Array array;
+        lexer.nextToken();
+        while (lexer.getToken() != Token::ARRAY_END) {
+            if (!array.empty()) {
+                if (lexer.getToken() != Token::COMMA) {
+                    throw Parser::Error(lexer);
+                }
+                lexer.nextToken();
+            }
+            array.push_back(readChild());
+            lexer.nextToken();
+        }
+        value = std::move(array);
+    }
+
+    // the parsed content replaces the span, a const value is only modified once parsing succeeded
+    Value& self = const_cast<Value&>(*this);
+    self.clearValue();
+    self.assignValue(std::move(value));
+}
+
+void Value::parseLazy(std::string text) {
+
+    std::shared_ptr<const std::string> source = std::make_shared<const std::string>(std::move(text));
+    SpanBuffer buffer(source->data(), source->size());
+    std::istream input(&buffer);
+    Lexer lexer(input);
+
+    if (lexer.getToken() != Token::OBJECT_START && lexer.getToken() != Token::ARRAY_START) {
+        // there is nothing to defer in a primitive value
+        SpanBuffer text(source->data(), source->size());
+        std::istream textInput(&text);
+        parse(textInput);
+        return;
+    }
+
+    Type rootType = lexer.getToken() == Token::OBJECT_START ? Type::OBJECT : Type::ARRAY;
+    size_t begin = lexer.getTokenOffset();
+    lexer.skipContainer();
+    if (lexer.getToken() == Token::END_OF_STREAM) {
+        throw Parser::Error(lexer);
+    }
+    size_t size = lexer.getOffset() - begin;
+    lexer.nextToken();
+    if (lexer.getToken() != Token::END_OF_STREAM) {
+        throw Parser::Error(lexer);
+    }
+
+    assign(createLazy(rootType, source, begin, size));
+}
+
+void Value::mergePatch(const Value& patch) {
+    if (!patch.hasType(Type::OBJECT)) {
+        assign(patch);
+        return;
+    }
+    if (!hasType(Type::OBJECT)) {
+        setObjectValue();
+    }
+    Object& object = getObjectValue();
+    for (const auto& item : patch.getObjectValue()) {
+        if (item.second.hasType(Type::NULL_)) {
+            auto it = object.find(item.first.view());
+            if (it != object.end()) {
+                object.erase(it);
+            }
+        } else {
+            // a new member is merged too, so that the nulls of an object are removed
+            object[item.first].mergePatch(item.second);
+        }
+    }
+}
+
+/**
+ * Moves an entry from an object to another.
+ * The node of a std::map is moved as it is if both maps use the same memory resource.
+ */
+template <class T>
+static void moveMember(T& object, T& members, typename T::iterator entry) {
+    if constexpr (HasExtract<T>::value) {
+        if (object.get_allocator() == members.get_allocator()) {
+            object.insert(members.extract(entry));
+            return;
+        }
+    }
+    object.try_emplace(entry->first, std::move(entry->second));
+}
+
+void Value::mergePatch(Value&& patch) {
+    if (!patch.hasType(Type::OBJECT)) {
+        assign(std::move(patch));
+        return;
+    }
+    if (!hasType(Type::OBJECT)) {
+        setObjectValue();
+    }
+    Object& object = getObjectValue();
+    Object& members = patch.getObjectValue();
+    for (auto it = members.begin(); it != members.end();) {
+        // the entry can be extracted, so the iterator is moved first
+        auto entry = it++;
+        auto target = object.find(entry->first.view());
+        if (entry->second.hasType(Type::NULL_)) {
+            if (target != object.end()) {
+                object.erase(target);
+            }
+        } else if (target != object.end()) {
+            target->second.mergePatch(std::move(entry->second));
+        } else if (entry->second.hasType(Type::OBJECT)) {
+            object[entry->first].mergePatch(std::move(entry->second));
+        } else {
+            moveMember(object, members, entry);
+        }
+    }
+}
+
+/**
+ * Applies a merge patch while it is parsed.
+ * The objects of the patch are merged into the objects on the stack, the arrays and their content are built
+ * as they are in the patch, like ValueParser does, and replace the members of the patched objects.
+ */
+class MergePatchParser : public Parser {
+
+    Value& root;
+    std::vector<Value*> stack;
+    std::string key;
+
+    // the number of arrays and objects on the stack that are copied from the patch instead of being merged,
+    // they are all above the merged objects
+    size_t copied = 0;
+
+    /**
+     * Returns where the next value of the patch goes : the root, a new value at the end of a copied container,
+     * or a member of a merged object.
+     */
+    Value& getTarget() {
+        if (stack.empty()) {
+            return root;
+        }
+        Value& parent = *stack.back();
+        if (parent.hasType(Type::ARRAY)) {
+            return parent.getArrayValue().emplace_back();
+        }
+        return parent.getObjectValue()[Key(std::move(key))];
+    }
+
+    template <class T>
+    void set(T&& value) {
+        getTarget() = std::forward<T>(value);
+    }
+
+    void onNumber(double value) override { set(value); }
+    void onInteger(int64_t value) override { set(value); }
+    void onUnsigned(uint64_t value) override { set(value); }
+    void onBoolean(bool value) override { set(value); }
+    void onString(std::string& value) override { set(std::move(value)); }
+    void onKey(std::string& key) override { this->key = std::move(key); }
+    void onIndex(size_t index) override {}
+
+    void onNull() override {
+        if (copied > 0 || stack.empty()) {
+            set(null);
+            return;
+        }
+        Object& object = stack.back()->getObjectValue();
+        auto it = object.find(key);
+        if (it != object.end()) {
+            object.erase(it);
+        }
+    }
+
+    void onObjectStart() override {
+        Value& target = getTarget();
+        if (copied > 0) {
+            target.setObjectValue();
+            copied++;
+        } else if (!target.hasType(Type::OBJECT)) {
+            target.setObjectValue();
+        }
+        stack.push_back(&target);
+    }
+
+    void onObjectEnd() override {
+        if (copied > 0) {
+            copied--;
+        }
+        stack.pop_back();
+    }
+
+    void onArrayStart() override {
+        Value& target = getTarget();
+        target.setArrayValue();
+        copied++;
+        stack.push_back(&target);
+    }
+
+    void onArrayEnd() override {
+        copied--;
+        stack.pop_back();
+    }
+
+public:
+
+    MergePatchParser(Value& value) : root(value) {}
+};
+
+void Value::mergePatch(std::istream& input) {
+    MergePatchParser(*this).parse(input);
+}
+
 Value parse(const std::string& json, const Path& path, bool unique) {
     Value value;
-    std::istringstream input(json);
-    value.parse(input);
+    value.parse(std::string_view(json), path, unique);
     return value;
 }
 
@@ -353,21 +1692,29 @@ const Value* Value::findFirst(Path::Cursor& cursor) const {
 
     if (cursor.isInPath()) {
 
+        materialize();
+
         switch (type) {
 
-            case Type::ARRAY:
-                for (size_t index = 0; index < arrayValue.size(); index++) {
+            case Type::ARRAY: {
+                // the elements of a packed array have no children, its values are only built to return one of them
+                const Array* array = packed ? nullptr : &arrayBlock->value;
+                for (size_t index = 0, size = getArraySize(); index < size; index++) {
                     cursor.next(index);
-                    const Value* child = arrayValue[index].findFirst(cursor);
+                    if (array == nullptr && cursor.isInTarget()) {
+                        array = &getArrayValue();
+                    }
+                    const Value* child = array != nullptr ? (*array)[index].findFirst(cursor) : nullptr;
                     if (child != nullptr) {
                         return child;
                     }
                     cursor.prev();
                 }
                 break;
+            }
 
             case Type::OBJECT:
-                for (const auto& item : objectValue) {
+                for (const auto& item : objectBlock->value) {
                     cursor.next(item.first);
                     const Value* child = item.second.findFirst(cursor);
                     if (child != nullptr) {
@@ -382,8 +1729,48 @@ const Value* Value::findFirst(Path::Cursor& cursor) const {
     return nullptr;
 }
 
+Value* Value::findFirst(Path::Cursor& cursor) {
+
+    if (cursor.isInTarget()) {
+        return this;
+    }
+
+    if (cursor.isInPath()) {
+
+        detach();
+
+        switch (type) {
+
+            case Type::ARRAY:
+                for (size_t index = 0; index < arrayBlock->value.size(); index++) {
+                    cursor.next(index);
+                    Value* child = arrayBlock->value[index].findFirst(cursor);
+                    if (child != nullptr) {
+                        return child;
+                    }
+                    cursor.prev();
+                }
+                break;
+
+            case Type::OBJECT:
+                for (auto& item : objectBlock->value) {
+                    cursor.next(item.first);
+                    Value* child = item.second.findFirst(cursor);
+                    if (child != nullptr) {
+                        return child;
+                    }
+                    cursor.prev();
+                }
+                break;
+        }
+    }
+
+    return nullptr;
+}
+
 Value* Value::findFirst(const Path& path) {
-    return const_cast<Value*>(static_cast<const Value&>(*this).findFirst(path));
+    Path::Cursor cursor(path);
+    return findFirst(cursor);
 }
 
 const Value* Value::findFirst(const Path& path) const {
@@ -399,18 +1786,20 @@ void Value::findAll(std::vector<Value*>& all, Path::Cursor& cursor) {
 
     if (cursor.isInPath()) {
 
+        detach();
+
         switch (type) {
 
             case Type::ARRAY:
-                for (size_t index = 0; index < arrayValue.size(); index++) {
+                for (size_t index = 0; index < arrayBlock->value.size(); index++) {
                     cursor.next(index);
-                    arrayValue[index].findAll(all, cursor);
+                    arrayBlock->value[index].findAll(all, cursor);
                     cursor.prev();
                 }
                 break;
 
             case Type::OBJECT:
-                for (auto& item : objectValue) {
+                for (auto& item : objectBlock->value) {
                     cursor.next(item.first);
                     item.second.findAll(all, cursor);
                     cursor.prev();
@@ -428,18 +1817,28 @@ void Value::findAll(std::vector<const Value*>& all, Path::Cursor& cursor) const
 
     if (cursor.isInPath()) {
 
+        materialize();
+
         switch (type) {
 
-            case Type::ARRAY:
-                for (size_t index = 0; index < arrayValue.size(); index++) {
+            case Type::ARRAY: {
+                // the elements of a packed array have no children, its values are only built to return some of them
+                const Array* array = packed ? nullptr : &arrayBlock->value;
+                for (size_t index = 0, size = getArraySize(); index < size; index++) {
                     cursor.next(index);
-                    arrayValue[index].findAll(all, cursor);
+                    if (array == nullptr && cursor.isInTarget()) {
+                        array = &getArrayValue();
+                    }
+                    if (array != nullptr) {
+                        (*array)[index].findAll(all, cursor);
+                    }
                     cursor.prev();
                 }
                 break;
+            }
 
             case Type::OBJECT:
-                for (const auto& item : objectValue) {
+                for (const auto& item : objectBlock->value) {
                     cursor.next(item.first);
                     item.second.findAll(all, cursor);
                     cursor.prev();